@@ -0,0 +1,219 @@
+#ifndef GOOGLEARROW_H
+#define GOOGLEARROW_H
+
+// The Arrow C data interface
+// (https://arrow.apache.org/docs/format/CDataInterface.html). The two structs
+// are the ABI itself, as given in the specification, so arrays can be handed
+// to and taken from arrow, nanoarrow, DuckDB or pyarrow without linking any of
+// them.
+//
+// Exported arrays own their buffers in `private_data`, and the release
+// callbacks only free memory, so a consumer may release them from any thread.
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema {
+  // Array type description
+  const char* format;
+  const char* name;
+  const char* metadata;
+  int64_t flags;
+  int64_t n_children;
+  struct ArrowSchema** children;
+  struct ArrowSchema* dictionary;
+
+  // Release callback
+  void (*release)(struct ArrowSchema*);
+  // Opaque producer-specific data
+  void* private_data;
+};
+
+struct ArrowArray {
+  // Array data description
+  int64_t length;
+  int64_t null_count;
+  int64_t offset;
+  int64_t n_buffers;
+  int64_t n_children;
+  const void** buffers;
+  struct ArrowArray** children;
+  struct ArrowArray* dictionary;
+
+  // Release callback
+  void (*release)(struct ArrowArray*);
+  // Opaque producer-specific data
+  void* private_data;
+};
+
+#endif  // ARROW_C_DATA_INTERFACE
+
+// ---- export ----
+
+struct ArrowSchemaData {
+  std::string format;
+  std::string name;
+  std::vector< ArrowSchema* > children;
+};
+
+inline void release_arrow_schema(ArrowSchema* schema) {
+  ArrowSchemaData* data = (ArrowSchemaData*)schema->private_data;
+  for (ArrowSchema* child : data->children) {
+    if (child->release != NULL) {
+      child->release(child);
+    }
+    delete child;
+  }
+  delete data;
+  schema->release = NULL;
+}
+
+// Fills `schema` as a non-nullable field of type `format`. The child
+// schemas are added to the ArrowSchemaData it returns.
+inline ArrowSchemaData* init_arrow_schema(ArrowSchema* schema, const char* format, const char* name) {
+  ArrowSchemaData* data = new ArrowSchemaData();
+  data->format = format;
+  data->name = name;
+  schema->format = data->format.c_str();
+  schema->name = data->name.c_str();
+  schema->metadata = NULL;
+  schema->flags = 0;
+  schema->n_children = 0;
+  schema->children = NULL;
+  schema->dictionary = NULL;
+  schema->release = &release_arrow_schema;
+  schema->private_data = data;
+  return data;
+}
+
+inline ArrowSchema* add_arrow_schema_child(ArrowSchema* parent, const char* format, const char* name) {
+  ArrowSchemaData* data = (ArrowSchemaData*)parent->private_data;
+  ArrowSchema* child = new ArrowSchema();
+  init_arrow_schema(child, format, name);
+  data->children.push_back(child);
+  parent->n_children = data->children.size();
+  parent->children = data->children.data();
+  return child;
+}
+
+// The buffers of one exported array: the string bytes (if any) and the
+// offsets, at 32 or 64 bits. There is never a validity bitmap.
+struct ArrowArrayData {
+  std::vector< char > data;
+  std::vector< int32_t > offsets32;
+  std::vector< int64_t > offsets64;
+  std::vector< const void* > buffers;
+  std::vector< ArrowArray* > children;
+};
+
+inline void release_arrow_array(ArrowArray* array) {
+  ArrowArrayData* data = (ArrowArrayData*)array->private_data;
+  for (ArrowArray* child : data->children) {
+    if (child->release != NULL) {
+      child->release(child);
+    }
+    delete child;
+  }
+  delete data;
+  array->release = NULL;
+}
+
+inline ArrowArrayData* init_arrow_array(ArrowArray* array, int64_t length) {
+  ArrowArrayData* data = new ArrowArrayData();
+  array->length = length;
+  array->null_count = 0;
+  array->offset = 0;
+  array->n_buffers = 0;
+  array->n_children = 0;
+  array->buffers = NULL;
+  array->children = NULL;
+  array->dictionary = NULL;
+  array->release = &release_arrow_array;
+  array->private_data = data;
+  return data;
+}
+
+inline ArrowArray* add_arrow_array_child(ArrowArray* parent, int64_t length) {
+  ArrowArrayData* data = (ArrowArrayData*)parent->private_data;
+  ArrowArray* child = new ArrowArray();
+  init_arrow_array(child, length);
+  data->children.push_back(child);
+  parent->n_children = data->children.size();
+  parent->children = data->children.data();
+  return child;
+}
+
+// Points the array at its buffers once they are filled. Empty buffers are
+// given a non-NULL address, as some consumers expect one.
+inline void set_arrow_buffers(ArrowArray* array, bool large, bool strings) {
+  static const int64_t empty = 0;
+  ArrowArrayData* data = (ArrowArrayData*)array->private_data;
+  data->buffers.clear();
+  data->buffers.push_back(NULL);
+  data->buffers.push_back(large ? (const void*)data->offsets64.data() : (const void*)data->offsets32.data());
+  if (strings) {
+    data->buffers.push_back(data->data.empty() ? (const void*)&empty : (const void*)data->data.data());
+  }
+  array->n_buffers = data->buffers.size();
+  array->buffers = data->buffers.data();
+}
+
+// ---- import ----
+
+enum ArrowPolylineType {
+  ARROW_UNSUPPORTED,
+  ARROW_UTF8,
+  ARROW_LARGE_UTF8,
+  ARROW_LIST,
+  ARROW_LARGE_LIST
+};
+
+inline ArrowPolylineType arrow_polyline_type(const ArrowSchema* schema) {
+  std::string format = schema->format == NULL ? "" : schema->format;
+  if (schema->dictionary != NULL) {
+    return ARROW_UNSUPPORTED;
+  }
+  if (format == "u") {
+    return ARROW_UTF8;
+  }
+  if (format == "U") {
+    return ARROW_LARGE_UTF8;
+  }
+  if (format == "+l" && schema->n_children == 1) {
+    return ARROW_LIST;
+  }
+  if (format == "+L" && schema->n_children == 1) {
+    return ARROW_LARGE_LIST;
+  }
+  return ARROW_UNSUPPORTED;
+}
+
+// Element i (including the array's own offset) is not null
+inline bool arrow_valid(const ArrowArray* array, int64_t i) {
+  const uint8_t* validity = (const uint8_t*)array->buffers[0];
+  return validity == NULL || (validity[i >> 3] >> (i & 7)) & 1;
+}
+
+// Start and end of element i (including the array's own offset)
+inline void arrow_offsets(const ArrowArray* array, bool large, int64_t i, int64_t* from, int64_t* to) {
+  if (large) {
+    const int64_t* offsets = (const int64_t*)array->buffers[1];
+    *from = offsets[i];
+    *to = offsets[i + 1];
+  } else {
+    const int32_t* offsets = (const int32_t*)array->buffers[1];
+    *from = offsets[i];
+    *to = offsets[i + 1];
+  }
+}
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef GOOGLECOLUMNAR_H
+#define GOOGLECOLUMNAR_H
+
+// The polylines of an sfc encoded in one contiguous run per thread, with the
+// nested offsets of the columnar layout. See rcpp_encodeSfGeometryColumnar().
+// The runs are copied into whichever buffer ends up holding them, an R raw
+// vector or an Arrow array.
+
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+#include "encoded_polylines.h"
+#include "threads.h"
+
+struct ColumnarRuns {
+
+  std::vector< EncodedPolylines > runs;
+  std::vector< size_t > run_offsets;
+  std::vector< size_t > geom_offsets;
+  std::vector< size_t > part_offsets;
+  std::vector< int > types;
+  size_t n_polylines;
+
+  ColumnarRuns() : n_polylines(0) {}
+
+  // The first polyline of run r
+  size_t first(size_t r) const {
+    return n_polylines * r / runs.size();
+  }
+
+  // Bytes in all the runs
+  size_t size() const {
+    return run_offsets.back();
+  }
+
+  // Copies the runs into `out`, which holds size() bytes, and the end of
+  // every polyline into offsets[1 .. n_polylines]
+  template <typename Offset>
+  void copy(char* out, Offset* offsets, int threads) const {
+
+    offsets[0] = 0;
+    parallel_for(runs.size(), threads, [&](size_t r, int) {
+      const EncodedPolylines& run = runs[r];
+      if (run.size > 0) {
+        std::memcpy(out + run_offsets[r], run.buffer.data(), run.size);
+      }
+      size_t from = first(r);
+      for (size_t k = 0; k < run.parts(); k++) {
+        offsets[from + k + 1] = run_offsets[r] + run.ends[k];
+      }
+    }, 1);
+  }
+};
+
+#endif
@@ -0,0 +1,290 @@
+#ifndef GOOGLEDECODER_H
+#define GOOGLEDECODER_H
+
+// Core of the polyline decoder. An encoded polyline is first sized by
+// counting its terminating chunks, so the caller can allocate the output
+// once, and then decoded straight into it.
+//
+// On x86-64 both passes work on 16 byte blocks with SSE2, which every x86-64
+// CPU has, so there is nothing to dispatch at runtime. Other platforms, and
+// the tail of each string, use the scalar loops.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "precision.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define POLYLINE_SSE2 1
+#endif
+
+// Encoded chunks are the chars '?' (63) to '~' (126). A chunk without the
+// continuation bit (0x20) ends a varint, i.e. any char below 95.
+#define MIN_POLYLINE_CHAR 63
+#define MAX_POLYLINE_CHAR 126
+#define VARINT_END_CHAR 95
+
+inline bool is_varint_end(char c) {
+  return (unsigned char)c < VARINT_END_CHAR;
+}
+
+// Counts the lat/lon pairs in an encoded polyline. Returns false if the
+// string holds chars outside the polyline alphabet, or ends part way through
+// a coordinate.
+inline bool polyline_size(const char* encoded, size_t len, size_t* n_points) {
+
+  size_t n_varints = 0;
+  size_t i = 0;
+
+#ifdef POLYLINE_SSE2
+  const __m128i lo = _mm_set1_epi8(MIN_POLYLINE_CHAR - 1);
+  const __m128i hi = _mm_set1_epi8(MAX_POLYLINE_CHAR + 1);
+  const __m128i end = _mm_set1_epi8(VARINT_END_CHAR);
+
+  for (; i + 16 <= len; i += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i*)(encoded + i));
+    // signed compares, so bytes >= 128 fail the lower bound
+    __m128i valid = _mm_and_si128(_mm_cmpgt_epi8(v, lo), _mm_cmplt_epi8(v, hi));
+    if (_mm_movemask_epi8(valid) != 0xFFFF) {
+      return false;
+    }
+    n_varints += __builtin_popcount(_mm_movemask_epi8(_mm_cmplt_epi8(v, end)));
+  }
+#endif
+
+  for (; i < len; i++) {
+    unsigned char c = encoded[i];
+    if (c < MIN_POLYLINE_CHAR || c > MAX_POLYLINE_CHAR) {
+      return false;
+    }
+    n_varints += is_varint_end(c);
+  }
+
+  if (n_varints % 2 != 0 || (len > 0 && !is_varint_end(encoded[len - 1]))) {
+    return false;
+  }
+  *n_points = n_varints / 2;
+  return true;
+}
+
+// Reads one varint starting at encoded[index], advancing index past it. The
+// chunks of an over-long varint that don't fit in a Varint are dropped.
+template <typename Varint = uint32_t>
+inline Varint read_varint(const char* encoded, size_t& index) {
+  Varint result = 0;
+  unsigned int shift = 0;
+  int b;
+  do {
+    b = encoded[index++] - 63;
+    if (shift < sizeof(Varint) * 8) {
+      result |= (Varint)(b & 0x1f) << shift;
+    }
+    shift += 5;
+  } while (b >= 0x20);
+  return result;
+}
+
+inline int32_t zigzag_decode(uint32_t result) {
+  return (result & 1) ? ~(int32_t)(result >> 1) : (int32_t)(result >> 1);
+}
+
+inline int64_t zigzag_decode(uint64_t result) {
+  return (result & 1) ? ~(int64_t)(result >> 1) : (int64_t)(result >> 1);
+}
+
+// Turns the stream of varints back into absolute coordinates. Varints
+// alternate lat, lon; the running sums are integers, so no precision is lost
+// however far the polyline travels.
+template <int P, typename Emit>
+struct PolylineAccumulator {
+  typedef typename PolylinePrecision<P>::coord_type coord_type;
+  typedef typename PolylinePrecision<P>::varint_type varint_type;
+
+  Emit& emit;
+  size_t i;
+  varint_type lat;
+  varint_type lng;
+  bool have_lat;
+
+  PolylineAccumulator(Emit& emit, coord_type lat, coord_type lng)
+    : emit(emit), i(0), lat((varint_type)lat), lng((varint_type)lng), have_lat(false) {}
+
+  void push(varint_type varint) {
+    if (!have_lat) {
+      lat += (varint_type)zigzag_decode(varint);
+      have_lat = true;
+    } else {
+      lng += (varint_type)zigzag_decode(varint);
+      emit(i++, (coord_type)lat, (coord_type)lng);
+      have_lat = false;
+    }
+  }
+};
+
+#ifdef POLYLINE_SSE2
+// Packs n (1 to 7) 5-bit chunks, low chunk first, into one varint without a
+// per-chunk loop: the chunks are read as one little-endian word and folded
+// together in pairs. Seven chunks hold 35 bits, enough for any delta at 1e7.
+inline uint64_t pack_chunks(const uint8_t* chunks, unsigned int n) {
+  uint64_t w;
+  std::memcpy(&w, chunks, sizeof(w));
+  w &= ~(uint64_t)0 >> (64 - 8 * n);
+  w = (w & 0x00FF00FF00FF00FFULL) | ((w & 0xFF00FF00FF00FF00ULL) >> 3);
+  w = (w & 0x0000FFFF0000FFFFULL) | ((w & 0xFFFF0000FFFF0000ULL) >> 6);
+  return (w & 0xFFFFFFFFULL) | ((w >> 32) << 20);
+}
+#endif
+
+// Decodes a polyline already validated by polyline_size(), calling
+// emit(i, lat, lon) for every point with the absolute coordinates in 10^-P
+// degree units. The running sums start from (lat, lon), so a polyline can be
+// decoded from part way through; see polyline_checkpoints().
+template <int P, typename Emit>
+inline void decode_polyline_scaled(const char* encoded, size_t len,
+                                   typename PolylinePrecision<P>::coord_type lat,
+                                   typename PolylinePrecision<P>::coord_type lon, Emit emit) {
+
+  typedef typename PolylinePrecision<P>::varint_type varint_type;
+  PolylineAccumulator<P, Emit> acc(emit, lat, lon);
+  size_t index = 0;
+
+#ifdef POLYLINE_SSE2
+  // Each block strips the 63 offset and continuation bits from 16 chars at
+  // once and finds the terminating chunks from a mask, then walks the set
+  // bits to assemble every varint that ends in the block. The block only
+  // advances past its last terminator, so no varint straddles two blocks.
+  const __m128i offset = _mm_set1_epi8(63);
+  const __m128i mask = _mm_set1_epi8(0x1f);
+  const __m128i end = _mm_set1_epi8(VARINT_END_CHAR);
+  alignas(16) uint8_t chunks[24] = {0};
+
+  while (index + 16 <= len) {
+    __m128i v = _mm_loadu_si128((const __m128i*)(encoded + index));
+    unsigned int ends = _mm_movemask_epi8(_mm_cmplt_epi8(v, end));
+    if (ends == 0) {
+      // a varint longer than a block; leave it to the scalar loop
+      break;
+    }
+    _mm_store_si128((__m128i*)chunks, _mm_and_si128(_mm_sub_epi8(v, offset), mask));
+
+    unsigned int start = 0;
+    while (ends) {
+      unsigned int stop = __builtin_ctz(ends);
+      unsigned int n_chunks = stop + 1 - start;
+      if (n_chunks > 7) {
+        break;
+      }
+      acc.push((varint_type)pack_chunks(chunks + start, n_chunks));
+      start = stop + 1;
+      ends &= ends - 1;
+    }
+    index += start;
+    if (ends) {
+      break;
+    }
+  }
+#endif
+
+  while (index < len) {
+    acc.push(read_varint<varint_type>(encoded, index));
+  }
+}
+
+template <int P, typename Emit>
+inline void decode_polyline_scaled(const char* encoded, size_t len, Emit emit) {
+  decode_polyline_scaled<P>(encoded, len, 0, 0, emit);
+}
+
+// Walks a polyline already validated by polyline_size(), calling
+// checkpoint(offset, lat, lon) before every `every`th point (but not the
+// first): the byte the point starts at and the running sums it is a delta
+// from. Decoding encoded + offset from those sums gives the rest of the
+// polyline.
+template <int P, typename Checkpoint>
+inline void polyline_checkpoints(const char* encoded, size_t len, size_t every, Checkpoint checkpoint) {
+
+  typedef typename PolylinePrecision<P>::coord_type coord_type;
+  typedef typename PolylinePrecision<P>::varint_type varint_type;
+  varint_type lat = 0;
+  varint_type lng = 0;
+  size_t index = 0;
+
+  for (size_t i = 0; index < len; i++) {
+    if (i > 0 && i % every == 0) {
+      checkpoint(index, (coord_type)lat, (coord_type)lng);
+    }
+    lat += (varint_type)zigzag_decode(read_varint<varint_type>(encoded, index));
+    lng += (varint_type)zigzag_decode(read_varint<varint_type>(encoded, index));
+  }
+}
+
+// Decodes into lat and lon, which must each hold n_points values
+template <int P>
+inline void decode_polyline_into(const char* encoded, size_t len, double* lat, double* lon) {
+  typedef typename PolylinePrecision<P>::coord_type coord_type;
+  decode_polyline_scaled<P>(encoded, len, [&](size_t i, coord_type ilat, coord_type ilon) {
+    lat[i] = ilat / PolylinePrecision<P>::scale();
+    lon[i] = ilon / PolylinePrecision<P>::scale();
+  });
+}
+
+// As above, keeping the coordinates as integer 10^-P degrees
+template <int P>
+inline void decode_polyline_into(const char* encoded, size_t len, int* lat, int* lon) {
+  typedef typename PolylinePrecision<P>::coord_type coord_type;
+  decode_polyline_scaled<P>(encoded, len, [&](size_t i, coord_type ilat, coord_type ilon) {
+    lat[i] = (int)ilat;
+    lon[i] = (int)ilon;
+  });
+}
+
+// The bounding box of polylines already validated by polyline_size(), in
+// 10^-P degree units. The min / max are tracked on the integer running sums
+// as the deltas are read, so nothing is written per point.
+template <int P>
+struct PolylineBBox {
+  typedef typename PolylinePrecision<P>::coord_type coord_type;
+
+  size_t n_points;
+  coord_type min_lat;
+  coord_type min_lon;
+  coord_type max_lat;
+  coord_type max_lon;
+
+  PolylineBBox() : n_points(0), min_lat(0), min_lon(0), max_lat(0), max_lon(0) {}
+
+  void add(const char* encoded, size_t len) {
+    decode_polyline_scaled<P>(encoded, len, [&](size_t, coord_type lat, coord_type lon) {
+      if (n_points == 0) {
+        min_lat = max_lat = lat;
+        min_lon = max_lon = lon;
+      } else {
+        min_lat = lat < min_lat ? lat : min_lat;
+        max_lat = lat > max_lat ? lat : max_lat;
+        min_lon = lon < min_lon ? lon : min_lon;
+        max_lon = lon > max_lon ? lon : max_lon;
+      }
+      n_points++;
+    });
+  }
+};
+
+// Picks the kernel for a precision checked to be from MIN_POLYLINE_PRECISION
+// to MAX_POLYLINE_PRECISION
+template <typename T>
+inline void decode_polyline_into(const char* encoded, size_t len, T* lat, T* lon, int precision) {
+  switch (precision) {
+  case 6:
+    decode_polyline_into<6>(encoded, len, lat, lon);
+    break;
+  case 7:
+    decode_polyline_into<7>(encoded, len, lat, lon);
+    break;
+  default:
+    decode_polyline_into<5>(encoded, len, lat, lon);
+  }
+}
+
+#endif
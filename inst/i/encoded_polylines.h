@@ -0,0 +1,74 @@
+#ifndef GOOGLEENCODEDPOLYLINES_H
+#define GOOGLEENCODEDPOLYLINES_H
+
+// The encoded polylines of one geometry, written back to back into a single
+// buffer. Each part is recorded by where it ends, and the SPLIT_CHAR markers
+// between polygons are flagged parts rather than bytes, so nothing has to be
+// joined, split or stripped before the CHARSXPs are made.
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+struct EncodedPolylines {
+
+  std::vector<char> buffer;
+  size_t size;
+  std::vector<size_t> ends;
+  std::vector<char> splits;
+
+  EncodedPolylines() : size(0) {}
+
+  void clear() {
+    size = 0;
+    ends.clear();
+    splits.clear();
+  }
+
+  // Makes room for n more bytes, returning where to write them. The
+  // pointer is invalidated by the next reserve().
+  char* reserve(size_t n) {
+    if (buffer.size() < size + n) {
+      buffer.resize(std::max(buffer.size() * 2, size + n));
+    }
+    return buffer.data() + size;
+  }
+
+  // Keeps the bytes written up to `end`
+  void wrote(const char* end) {
+    size = end - buffer.data();
+  }
+
+  // Ends the current polyline
+  void end_part() {
+    ends.push_back(size);
+    splits.push_back(0);
+  }
+
+  void split() {
+    ends.push_back(size);
+    splits.push_back(1);
+  }
+
+  // MULTI* objects end on a split, which isn't kept
+  void pop_split() {
+    if (!splits.empty() && splits.back()) {
+      ends.pop_back();
+      splits.pop_back();
+    }
+  }
+
+  size_t parts() const {
+    return ends.size();
+  }
+
+  size_t begin(size_t i) const {
+    return i == 0 ? 0 : ends[i - 1];
+  }
+
+  bool is_split(size_t i) const {
+    return splits[i] != 0;
+  }
+};
+
+#endif
@@ -0,0 +1,141 @@
+#ifndef GOOGLEENCODER_H
+#define GOOGLEENCODER_H
+
+// Core of the polyline encoder. Deltas are written straight into a caller
+// supplied char buffer, which must hold at least max_encoded_size<P>(n) bytes.
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include "precision.h"
+
+// Deltas of lon/lat at 1e5 fit in 27 bits (6 chars), but projected or out of
+// range inputs can use the full width.
+template <int P = 5>
+inline size_t max_encoded_size(size_t n) {
+  return n * 2 * PolylinePrecision<P>::max_varint_chars;
+}
+
+// Writes the 5-bit chunks of num, low chunk first, with the continuation bit
+// set on every chunk but the last. The chunk count comes from the bit length,
+// so the only branch is the (predictable) loop bound.
+inline char* write_varint(char* out, uint32_t num) {
+  int bits = 32 - __builtin_clz(num | 1);
+  int len = (bits + 4) / 5;
+  for (int i = 0; i < len - 1; i++) {
+    out[i] = (char)((0x20 | ((num >> (5 * i)) & 0x1f)) + 63);
+  }
+  out[len - 1] = (char)((num >> (5 * (len - 1))) + 63);
+  return out + len;
+}
+
+inline char* write_varint(char* out, uint64_t num) {
+  int bits = 64 - __builtin_clzll(num | 1);
+  int len = (bits + 4) / 5;
+  for (int i = 0; i < len - 1; i++) {
+    out[i] = (char)((0x20 | ((num >> (5 * i)) & 0x1f)) + 63);
+  }
+  out[len - 1] = (char)((num >> (5 * (len - 1))) + 63);
+  return out + len;
+}
+
+inline char* write_signed_varint(char* out, int32_t num) {
+  uint32_t ui = (uint32_t)num << 1;
+  ui = (num < 0) ? ~ui : ui;
+  return write_varint(out, ui);
+}
+
+inline char* write_signed_varint(char* out, int64_t num) {
+  uint64_t ui = (uint64_t)num << 1;
+  ui = (num < 0) ? ~ui : ui;
+  return write_varint(out, ui);
+}
+
+// Writes one lon/lat pair as deltas from the previous pair (plat, plon),
+// which are updated. For readers that stream coordinates one at a time.
+template <int P = 5>
+inline char* write_coordinate(char* out, double lon, double lat,
+                              typename PolylinePrecision<P>::coord_type& plat,
+                              typename PolylinePrecision<P>::coord_type& plon) {
+
+  typedef typename PolylinePrecision<P>::coord_type coord_type;
+
+  coord_type ilat = lat * PolylinePrecision<P>::scale();
+  coord_type ilon = lon * PolylinePrecision<P>::scale();
+
+  // the subtraction wraps rather than overflows; the decoder's running sums
+  // wrap back
+  typedef typename PolylinePrecision<P>::varint_type varint_type;
+  out = write_signed_varint(out, (coord_type)((varint_type)ilat - (varint_type)plat));
+  out = write_signed_varint(out, (coord_type)((varint_type)ilon - (varint_type)plon));
+
+  plat = ilat;
+  plon = ilon;
+  return out;
+}
+
+// Encodes n lon/lat pairs into `out`, returning one past the last byte written
+template <int P = 5>
+inline char* write_polyline(char* out, const double* lons, const double* lats, size_t n) {
+
+  typename PolylinePrecision<P>::coord_type plat = 0;
+  typename PolylinePrecision<P>::coord_type plon = 0;
+
+  for (size_t i = 0; i < n; i++) {
+    out = write_coordinate<P>(out, lons[i], lats[i], plat, plon);
+  }
+  return out;
+}
+
+// The ZM stream runs parallel to the XY polylines, with M in the latitude
+// slot and Z in the longitude slot of each pair, as if the polyline were
+// encodeCoordinates(lon = Z, lat = M). Each has its own precision, so the
+// scales are runtime values and the deltas are always 64 bit.
+inline size_t max_zm_encoded_size(size_t n) {
+  return n * 2 * MAX_VARINT64_CHARS;
+}
+
+// An NA or NaN Z / M is written as this value, which no finite one scales
+// to, and decodes back to NA
+#define ZM_NA INT64_MIN
+
+// Scales a Z or M value to an integer. Returns false if it is infinite or
+// too large for 64 bits, where the cast would be undefined.
+inline bool scale_zm(double v, double scale, int64_t* out) {
+  if (std::isnan(v)) {
+    *out = ZM_NA;
+    return true;
+  }
+  double scaled = v * scale;
+  if (!(scaled > -9.2e18 && scaled < 9.2e18)) {
+    return false;
+  }
+  *out = (int64_t)scaled;
+  return true;
+}
+
+// Encodes n Z / M pairs into `out`, which must hold max_zm_encoded_size(n)
+// bytes. A NULL z or m (XYM or XYZ) is encoded as 0. Returns NULL if a value
+// can't be encoded.
+inline char* write_zm_polyline(char* out, const double* z, const double* m, size_t n,
+                               double z_scale, double m_scale) {
+
+  int64_t pz = 0;
+  int64_t pm = 0;
+
+  for (size_t i = 0; i < n; i++) {
+    int64_t iz = 0;
+    int64_t im = 0;
+    if ((z != NULL && !scale_zm(z[i], z_scale, &iz)) || (m != NULL && !scale_zm(m[i], m_scale, &im))) {
+      return NULL;
+    }
+    out = write_signed_varint(out, (int64_t)((uint64_t)im - (uint64_t)pm));
+    out = write_signed_varint(out, (int64_t)((uint64_t)iz - (uint64_t)pz));
+    pz = iz;
+    pm = im;
+  }
+  return out;
+}
+
+#endif
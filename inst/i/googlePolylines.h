@@ -4,6 +4,9 @@ using namespace Rcpp;
 #ifndef GOOGLEPOLYLINES_H
 #define GOOGLEPOLYLINES_H
 
+#include "columnar.h"
+#include "encoded_polylines.h"
+
 #define SF_Unknown             0
 #define SF_Point               1
 #define SF_LineString          2
@@ -32,39 +35,128 @@ using namespace Rcpp;
 #define XYM       3
 #define XYZM      4
 
-void addToStream(std::ostringstream& os) ; 
+// Where a geometry's Z and M columns are, counting X as 0, and how they are
+// scaled for the ZM stream. A column of 0 means the dimension is missing.
+struct ZMStream {
+  int z_col;
+  int m_col;
+  double z_scale;
+  double m_scale;
+
+  bool empty() const {
+    return z_col == 0 && m_col == 0;
+  }
+};
+
+ZMStream make_zm_stream(const char* dim, int z_precision, int m_precision);
+
+// Where a parallel worker wrote one row's output: the worker's own buffer,
+// and [first, last) of it, in parts or bytes as the buffer counts them
+struct EncodedRange {
+  int worker;
+  size_t first;
+  size_t last;
+};
+
+// Scratch state for encoding polylines. Each call (or worker) owns its own
+// encoder, so nothing is shared between concurrent encodes. With `zm`, the
+// Z and M of every polyline are encoded into zm_polylines in the same pass.
+struct PolylineEncoder {
+  std::vector<char> buffer;
+  EncodedPolylines polylines;
+  int precision;
+  bool zm;
+  EncodedPolylines zm_polylines;
+  ZMStream zm_stream;
+
+  explicit PolylineEncoder(int precision = 5) : precision(precision), zm(false), zm_stream() {}
+};
+
+// One polyline of n coordinates, gathered from an sfg on the main thread so it
+// can be encoded without touching R. A `split` part marks the SPLIT_CHAR
+// boundary between polygons.
+struct PolylinePart {
+  const double* lon;
+  const double* lat;
+  size_t n;
+  bool split;
+};
 
-template<typename Out>
-void split(const std::string &s, char delim, Out result);
+Rcpp::CharacterVector getSfClass(SEXP sf);
 
-void split(const std::string &s, char delim);
+Rcpp::List decode_polyline(const char* encoded, size_t len,
+                           std::vector<std::string>& col_headers,
+                           bool integer = false, int precision = 5);
 
-Rcpp::CharacterVector getSfClass(SEXP sf);
+Rcpp::IntegerVector compact_row_names(R_xlen_t n);
+
+// An encoded polyline's bytes, read from its CHARSXP on the main thread
+struct PolylineView {
+  const char* encoded;
+  size_t len;
+  bool na;
+};
+
+PolylineView polyline_view(SEXP s);
+
+inline bool is_split(const PolylineView& view) {
+  return view.len == 1 && view.encoded[0] == SPLIT_CHAR[0];
+}
+
+// The buffer and offsets of an encoded_columnar object, checked and read on
+// the main thread. See rcpp_encodeSfGeometryColumnar() for the layout.
+struct ColumnarPolylines {
+  const char* buffer;
+  const int* polyline_offsets;
+  const int* part_offsets;
+  const int* geom_offsets;
+  const int* types;
+  R_xlen_t n;
+};
+
+ColumnarPolylines columnar_polylines(Rcpp::List columnar);
+
+int columnar_views(const ColumnarPolylines& columnar, int feature,
+                   std::vector< PolylineView >& views, bool splits);
 
-Rcpp::List decode_polyline(std::string encoded, 
-                           std::vector<std::string>& col_headers, 
-                           std::vector<double>& pointsLat, 
-                           std::vector<double>& pointsLon);
+Rcpp::List decode_views(std::vector< PolylineView >& views, 
+                        std::vector< std::vector<std::string> >& col_headers,
+                        std::vector< size_t >& header_index,
+                        bool integer, int precision, int threads);
+
+Rcpp::List decode_views_flat(std::vector< PolylineView >& views,
+                             std::vector< int >& ids,
+                             std::vector< int >& part_ids,
+                             bool integer, int precision, int threads);
+
+Rcpp::List decode_grouped_views(std::vector< PolylineView >& views, std::vector< size_t >& offsets,
+                                bool integer, int precision, int threads);
+
+Rcpp::List decode_polyline_parallel(Rcpp::StringVector encodedStrings, Rcpp::String encoded_type,
+                                    bool integer, int precision, int threads);
+
+Rcpp::List decode_polyline_list_parallel(Rcpp::List encodedList, std::string attribute, 
+                                         bool integer, int precision, int threads);
 
 std::vector<std::string> get_col_headers(Rcpp::String sfg_dim);
 
-Rcpp::List na_dataframe(std::vector<std::string>& col_headers);
+Rcpp::List na_dataframe(std::vector<std::string>& col_headers, bool integer = false);
 
-void EncodeNumber(std::ostringstream& os, int num);
+std::string encode_polyline(PolylineEncoder& enc, const double* lons, const double* lats, size_t n);
 
-void EncodeSignedNumber(std::ostringstream& os, int num);
+void add_polyline(EncodedPolylines& out, int precision, const double* lons, const double* lats, size_t n);
 
-std::string encode_polyline();
+bool add_zm_polyline(EncodedPolylines& out, const ZMStream& zm, const double* lons, const double* lats, size_t n);
 
-Rcpp::List decode_data(Rcpp::StringVector pl,
-                 const char *cls = NULL);
+Rcpp::CharacterVector polyline_strings(const EncodedPolylines& polylines, size_t from, size_t to);
 
+Rcpp::CharacterVector polyline_strings(const EncodedPolylines& polylines);
 
-namespace global_vars {
-  extern std::vector<double> lons;
-  extern std::vector<double> lats;
-  extern std::string encodedString;
-  extern std::vector<std::string> elems;
-}
+void make_type(const char *cls, int *tp = NULL, int srid = 0);
+
+void encode_columnar(Rcpp::List sfc, int precision, int threads, ColumnarRuns& out);
+
+SEXP decode_data(std::vector< PolylineView >& views, double* bbox, int precision,
+                 const char *cls = NULL);
 
 #endif
@@ -0,0 +1,49 @@
+#ifndef GOOGLEPRECISION_H
+#define GOOGLEPRECISION_H
+
+// Polyline precision. Coordinates are encoded as integer multiples of 10^-P
+// degrees: Google's polylines use P = 5, OSRM and Valhalla's polyline6 use
+// P = 6. The encoder and decoder kernels are templated on P, so each
+// precision compiles to its own constant scale.
+//
+// At P = 7 a coordinate still fits in 32 bits, but the delta between two of
+// them (up to 3.6e9 for longitudes) does not, so the deltas and running sums
+// are 64 bit.
+
+#include <cstdint>
+
+#define MIN_POLYLINE_PRECISION 5
+#define MAX_POLYLINE_PRECISION 7
+
+// A zig-zagged delta needs at most ceil(bits / 5) chars
+#define MAX_VARINT_CHARS   7
+#define MAX_VARINT64_CHARS 13
+
+template <int P>
+struct PolylinePrecision;
+
+template <>
+struct PolylinePrecision<5> {
+  typedef int32_t coord_type;
+  typedef uint32_t varint_type;
+  static const int max_varint_chars = MAX_VARINT_CHARS;
+  static double scale() { return 1e5; }
+};
+
+template <>
+struct PolylinePrecision<6> {
+  typedef int32_t coord_type;
+  typedef uint32_t varint_type;
+  static const int max_varint_chars = MAX_VARINT_CHARS;
+  static double scale() { return 1e6; }
+};
+
+template <>
+struct PolylinePrecision<7> {
+  typedef int64_t coord_type;
+  typedef uint64_t varint_type;
+  static const int max_varint_chars = MAX_VARINT64_CHARS;
+  static double scale() { return 1e7; }
+};
+
+#endif
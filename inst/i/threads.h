@@ -0,0 +1,83 @@
+#ifndef GOOGLETHREADS_H
+#define GOOGLETHREADS_H
+
+// Minimal worker pool for the parallel encoders / decoders.
+//
+// Nothing in here touches the R API; callers gather everything they need from
+// R on the main thread, run the pure C++ work through parallel_for(), and then
+// build the R results on the main thread again. The encoder, decoder, WKT /
+// WKB, columnar and Arrow headers keep to the same rule, so any of them can
+// run on a worker.
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Calls fn(i, worker) for every i in [0, n) using `threads` workers.
+// Indices are handed out in blocks of `grain` so uneven features stay
+// balanced. `worker` (0 .. threads - 1) lets callers keep per-thread scratch
+// buffers. The first exception thrown by a worker is re-thrown here once all
+// workers have stopped.
+template <typename F>
+void parallel_for(size_t n, int threads, F fn, size_t grain = 64) {
+
+  if (threads < 1) {
+    threads = 1;
+  }
+  if (grain < 1) {
+    grain = 1;
+  }
+  size_t blocks = (n + grain - 1) / grain;
+  if ((size_t)threads > blocks) {
+    threads = blocks > 0 ? (int)blocks : 1;
+  }
+
+  if (threads == 1) {
+    for (size_t i = 0; i < n; i++) {
+      fn(i, 0);
+    }
+    return;
+  }
+
+  std::atomic<size_t> next(0);
+  std::atomic<bool> failed(false);
+  std::exception_ptr error;
+  std::mutex error_mutex;
+
+  auto work = [&](int worker) {
+    try {
+      size_t begin;
+      while (!failed && (begin = next.fetch_add(grain)) < n) {
+        size_t end = std::min(begin + grain, n);
+        for (size_t i = begin; i < end; i++) {
+          fn(i, worker);
+        }
+      }
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(error_mutex);
+      if (!error) {
+        error = std::current_exception();
+      }
+      failed = true;
+    }
+  };
+
+  std::vector<std::thread> pool;
+  pool.reserve(threads - 1);
+  for (int t = 1; t < threads; t++) {
+    pool.emplace_back(work, t);
+  }
+  work(0);
+  for (auto& th : pool) {
+    th.join();
+  }
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+#endif
@@ -0,0 +1,215 @@
+#ifndef GOOGLEWKBREADER_H
+#define GOOGLEWKBREADER_H
+
+// Well-known binary reader. Walks the WKB of one geometry in place and
+// writes the deltas of its coordinates straight to the encoder, one polyline
+// per point / line / ring, as WktPolylineReader does for text.
+//
+// Reads ISO WKB (Z / M / ZM as type + 1000 / 2000 / 3000) and PostGIS EWKB
+// (Z / M / SRID flags in the high bits), in either byte order.
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "encoded_polylines.h"
+#include "encoder.h"
+
+#define WKB_POINT              1
+#define WKB_LINESTRING         2
+#define WKB_POLYGON            3
+#define WKB_MULTIPOINT         4
+#define WKB_MULTILINESTRING    5
+#define WKB_MULTIPOLYGON       6
+#define WKB_GEOMETRYCOLLECTION 7
+
+#define EWKB_Z_FLAG    0x80000000
+#define EWKB_M_FLAG    0x40000000
+#define EWKB_SRID_FLAG 0x20000000
+
+inline bool host_is_little_endian() {
+  uint16_t one = 1;
+  unsigned char first;
+  std::memcpy(&first, &one, 1);
+  return first == 1;
+}
+
+inline const char* wkb_type_name(uint32_t type) {
+  switch (type) {
+  case WKB_POINT:              return "POINT";
+  case WKB_LINESTRING:         return "LINESTRING";
+  case WKB_POLYGON:            return "POLYGON";
+  case WKB_MULTIPOINT:         return "MULTIPOINT";
+  case WKB_MULTILINESTRING:    return "MULTILINESTRING";
+  case WKB_MULTIPOLYGON:       return "MULTIPOLYGON";
+  case WKB_GEOMETRYCOLLECTION: return "GEOMETRYCOLLECTION";
+  default:                     return "UNKNOWN";
+  }
+}
+
+template <int P>
+struct WkbPolylineReader {
+
+  const unsigned char* p;
+  const unsigned char* end;
+  bool swap;
+  EncodedPolylines* out;
+
+  WkbPolylineReader() : p(NULL), end(NULL), swap(false), out(NULL) {}
+
+  bool remaining(size_t n) {
+    return (size_t)(end - p) >= n;
+  }
+
+  uint32_t read_uint32() {
+    unsigned char b[4];
+    std::memcpy(b, p, 4);
+    if (swap) {
+      std::swap(b[0], b[3]);
+      std::swap(b[1], b[2]);
+    }
+    uint32_t v;
+    std::memcpy(&v, b, 4);
+    p += 4;
+    return v;
+  }
+
+  double read_double() {
+    unsigned char b[8];
+    std::memcpy(b, p, 8);
+    if (swap) {
+      std::reverse(b, b + 8);
+    }
+    double v;
+    std::memcpy(&v, b, 8);
+    p += 8;
+    return v;
+  }
+
+  // Reads a geometry's byte order and type, returning the base type and
+  // setting the number of ordinates per coordinate
+  bool header(uint32_t* type, int* dims) {
+    if (!remaining(5) || *p > 1) return false;
+    swap = (*p++ == 1) != host_is_little_endian();
+
+    uint32_t t = read_uint32();
+    *dims = 2 + ((t & EWKB_Z_FLAG) != 0) + ((t & EWKB_M_FLAG) != 0);
+    if (t & EWKB_SRID_FLAG) {
+      if (!remaining(4)) return false;
+      read_uint32();
+    }
+    t &= 0x0FFFFFFF;
+
+    // ISO dimensions
+    switch (t / 1000) {
+    case 1: case 2: *dims = 3; break;
+    case 3: *dims = 4; break;
+    }
+    *type = t % 1000;
+    return true;
+  }
+
+  // Reads n coordinates as one polyline
+  bool coordinates(uint32_t n, int dims) {
+    size_t width = 8 * (size_t)dims;
+    if ((size_t)(end - p) / width < n) return false;
+
+    char* o = out->reserve(max_encoded_size<P>(n));
+    typename PolylinePrecision<P>::coord_type plat = 0;
+    typename PolylinePrecision<P>::coord_type plon = 0;
+    for (uint32_t i = 0; i < n; i++) {
+      const unsigned char* next = p + width;
+      double lon = read_double();
+      double lat = read_double();
+      o = write_coordinate<P>(o, lon, lat, plat, plon);
+      p = next;
+    }
+    out->wrote(o);
+    out->end_part();
+    return true;
+  }
+
+  bool point(int dims) {
+    if (!remaining(8 * (size_t)dims)) return false;
+    const unsigned char* at = p;
+    double lon = read_double();
+    double lat = read_double();
+    p = at;
+    // POINT EMPTY is written with NaN coordinates
+    if (std::isnan(lon) && std::isnan(lat)) {
+      p += 8 * (size_t)dims;
+      return true;
+    }
+    return coordinates(1, dims);
+  }
+
+  bool linestring(int dims) {
+    if (!remaining(4)) return false;
+    return coordinates(read_uint32(), dims);
+  }
+
+  bool polygon(int dims) {
+    if (!remaining(4)) return false;
+    uint32_t n = read_uint32();
+    for (uint32_t i = 0; i < n; i++) {
+      if (!linestring(dims)) return false;
+    }
+    return true;
+  }
+
+  // Each part of a MULTI* geometry is a full geometry of type `part_type`
+  bool parts(uint32_t part_type) {
+    if (!remaining(4)) return false;
+    uint32_t n = read_uint32();
+    for (uint32_t i = 0; i < n; i++) {
+      uint32_t type;
+      int dims;
+      if (!header(&type, &dims) || type != part_type) return false;
+      bool ok = type == WKB_POINT ? point(dims)
+        : type == WKB_LINESTRING ? linestring(dims)
+        : polygon(dims);
+      if (!ok) return false;
+      if (type == WKB_POLYGON) {
+        out->split();
+      }
+    }
+    return true;
+  }
+
+  // Reads `wkb` into `polylines`, setting `type` to its geometry type. An
+  // unsupported type gives no polylines. Returns false if the bytes are not
+  // valid WKB.
+  bool read(const unsigned char* wkb, size_t len, EncodedPolylines& polylines, std::string& type) {
+
+    p = wkb;
+    end = wkb + len;
+    out = &polylines;
+    polylines.clear();
+
+    uint32_t geometry_type;
+    int dims;
+    if (!header(&geometry_type, &dims)) return false;
+    type = wkb_type_name(geometry_type);
+
+    bool ok;
+    switch (geometry_type) {
+    case WKB_POINT:           ok = point(dims); break;
+    case WKB_LINESTRING:      ok = linestring(dims); break;
+    case WKB_POLYGON:         ok = polygon(dims); break;
+    case WKB_MULTIPOINT:      ok = parts(WKB_POINT); break;
+    case WKB_MULTILINESTRING: ok = parts(WKB_LINESTRING); break;
+    case WKB_MULTIPOLYGON:    ok = parts(WKB_POLYGON); break;
+    default:
+      return true;
+    }
+
+    polylines.pop_split();
+    return ok && p == end;
+  }
+};
+
+#endif
@@ -0,0 +1,205 @@
+#ifndef GOOGLEWKBWRITER_H
+#define GOOGLEWKBWRITER_H
+
+// Well-known binary writer for decoded polylines, laid out as
+// sf::st_as_binary() writes XY geometries: ISO WKB, with every part of a
+// MULTI* geometry given its own byte order and type.
+//
+// Each geometry is walked twice, first with no output to find its exact
+// size, then decoding the varints straight into the allocated bytes.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "decoder.h"
+#include "wkb_reader.h"
+
+// A polyline's bytes and its point count, from polyline_size()
+struct WkbPolyline {
+  const char* encoded;
+  size_t len;
+  size_t n;
+  bool split;
+};
+
+template <int P>
+struct WkbWriter {
+
+  typedef typename PolylinePrecision<P>::coord_type coord_type;
+
+  unsigned char* out;
+  size_t pos;
+  bool big_endian;
+  bool swap;
+  double empty;
+  bool overflow;
+
+  // `out` NULL only counts the bytes; `empty` is the coordinate written for
+  // POINT EMPTY
+  WkbWriter(unsigned char* out, bool big_endian, double empty)
+    : out(out), pos(0), big_endian(big_endian), swap(big_endian == host_is_little_endian()), empty(empty), overflow(false) {}
+
+  void put_uint32(uint32_t v) {
+    if (out) {
+      unsigned char b[4];
+      std::memcpy(b, &v, 4);
+      if (swap) {
+        std::reverse(b, b + 4);
+      }
+      std::memcpy(out + pos, b, 4);
+    }
+    pos += 4;
+  }
+
+  // A ring, point or part count, which WKB holds in 32 bits. A larger one
+  // sets `overflow`, for the caller to check after the sizing pass.
+  void put_count(size_t n) {
+    if (n > UINT32_MAX) {
+      overflow = true;
+    }
+    put_uint32((uint32_t)n);
+  }
+
+  void put_double(size_t at, double v) {
+    unsigned char b[8];
+    std::memcpy(b, &v, 8);
+    if (swap) {
+      std::reverse(b, b + 8);
+    }
+    std::memcpy(out + at, b, 8);
+  }
+
+  void header(uint32_t type) {
+    if (out) {
+      out[pos] = big_endian ? 0 : 1;
+    }
+    pos += 1;
+    put_uint32(type);
+  }
+
+  // Writes the points of a polyline as x, y pairs
+  void points(const WkbPolyline& pl) {
+    if (out) {
+      size_t at = pos;
+      decode_polyline_scaled<P>(pl.encoded, pl.len, [&](size_t i, coord_type lat, coord_type lon) {
+        put_double(at + 16 * i, lon / PolylinePrecision<P>::scale());
+        put_double(at + 16 * i + 8, lat / PolylinePrecision<P>::scale());
+      });
+    }
+    pos += 16 * pl.n;
+  }
+
+  void point(const WkbPolyline* pl) {
+    header(WKB_POINT);
+    if (pl == NULL) {
+      if (out) {
+        put_double(pos, empty);
+        put_double(pos + 8, empty);
+      }
+      pos += 16;
+      return;
+    }
+    points(*pl);
+  }
+
+  void linestring(const WkbPolyline* first, const WkbPolyline* last) {
+    size_t n = 0;
+    for (const WkbPolyline* pl = first; pl != last; pl++) {
+      n += pl->n;
+    }
+    put_count(n);
+    for (const WkbPolyline* pl = first; pl != last; pl++) {
+      points(*pl);
+    }
+  }
+
+  // Rings [first, last) of one polygon
+  void polygon(const WkbPolyline* first, const WkbPolyline* last) {
+    put_count(last - first);
+    for (const WkbPolyline* pl = first; pl != last; pl++) {
+      linestring(pl, pl + 1);
+    }
+  }
+
+  // The first ring of the polygon after the one starting at `from`. Polygons
+  // are separated by SPLIT_CHAR.
+  static const WkbPolyline* next_polygon(const WkbPolyline* from, const WkbPolyline* last) {
+    while (from != last && !from->split) {
+      from++;
+    }
+    return from == last ? last : from + 1;
+  }
+
+  // Writes one geometry of the given WKB type from its polylines
+  void geometry(uint32_t type, const std::vector< WkbPolyline >& pls) {
+
+    const WkbPolyline* first = pls.data();
+    const WkbPolyline* last = pls.data() + pls.size();
+
+    switch (type) {
+    case WKB_POINT:
+      point(pls.empty() ? NULL : first);
+      break;
+    case WKB_LINESTRING:
+      header(type);
+      linestring(first, last);
+      break;
+    case WKB_POLYGON:
+      header(type);
+      polygon(first, last);
+      break;
+    case WKB_MULTIPOINT: {
+      header(type);
+      size_t n = 0;
+      for (const WkbPolyline* pl = first; pl != last; pl++) {
+        n += pl->n;
+      }
+      put_count(n);
+      // usually one point per polyline, but split up any that hold more
+      for (const WkbPolyline* pl = first; pl != last; pl++) {
+        if (!out) {
+          pos += 21 * pl->n;
+          continue;
+        }
+        decode_polyline_scaled<P>(pl->encoded, pl->len, [&](size_t, coord_type lat, coord_type lon) {
+          header(WKB_POINT);
+          put_double(pos, lon / PolylinePrecision<P>::scale());
+          put_double(pos + 8, lat / PolylinePrecision<P>::scale());
+          pos += 16;
+        });
+      }
+      break;
+    }
+    case WKB_MULTILINESTRING:
+      header(type);
+      put_count(pls.size());
+      for (const WkbPolyline* pl = first; pl != last; pl++) {
+        header(WKB_LINESTRING);
+        linestring(pl, pl + 1);
+      }
+      break;
+    case WKB_MULTIPOLYGON: {
+      header(type);
+      size_t n = 0;
+      for (const WkbPolyline* from = first; from != last; from = next_polygon(from, last)) {
+        n++;
+      }
+      put_count(n);
+      for (const WkbPolyline* from = first; from != last; from = next_polygon(from, last)) {
+        const WkbPolyline* to = from;
+        while (to != last && !to->split) {
+          to++;
+        }
+        header(WKB_POLYGON);
+        polygon(from, to);
+      }
+      break;
+    }
+    }
+  }
+};
+
+#endif
@@ -13,9 +13,8 @@ using namespace Rcpp;
 #define MULTIPOLYGON      6
 
 
-void polylineToWKT(std::ostringstream& os, std::string encoded);
-
-std::string geomFromWKT(std::string& pl);
+#include "wkt_writer.h"
 
+bool polylineToWKT(WktWriter& os, const char* encoded, size_t len);
 
 #endif
@@ -0,0 +1,271 @@
+#ifndef GOOGLEWKTREADER_H
+#define GOOGLEWKTREADER_H
+
+// Single pass well-known text reader. Coordinates are parsed straight off the
+// text and their deltas written to the encoder as they are read, one
+// polyline per point / line / ring, without building any geometry first.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "encoded_polylines.h"
+#include "encoder.h"
+
+// Powers of ten that are exact doubles
+static const double WKT_POW10[] = {
+  1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// Parses a decimal number at p, advancing p past it. Numbers with at most 15
+// significant digits and a small exponent (all coordinates in practice) are
+// a single exact multiply or divide of two exact doubles, so they round the
+// same as strtod(); anything else falls back to strtod().
+inline bool parse_wkt_double(const char*& p, const char* end, double* value) {
+
+  const char* start = p;
+  bool negative = false;
+  if (p < end && (*p == '-' || *p == '+')) {
+    negative = *p == '-';
+    p++;
+  }
+
+  uint64_t mantissa = 0;
+  int digits = 0;
+  int exponent = 0;
+  bool any = false;
+
+  for (; p < end && *p >= '0' && *p <= '9'; p++) {
+    any = true;
+    if (digits < 19) {
+      mantissa = mantissa * 10 + (*p - '0');
+      digits += mantissa > 0;
+    } else {
+      exponent++;
+    }
+  }
+  if (p < end && *p == '.') {
+    p++;
+    for (; p < end && *p >= '0' && *p <= '9'; p++) {
+      any = true;
+      if (digits < 19) {
+        mantissa = mantissa * 10 + (*p - '0');
+        digits += mantissa > 0;
+        exponent--;
+      }
+    }
+  }
+  if (!any) {
+    p = start;
+    return false;
+  }
+  if (p < end && (*p == 'e' || *p == 'E')) {
+    const char* e = p + 1;
+    bool e_negative = false;
+    if (e < end && (*e == '-' || *e == '+')) {
+      e_negative = *e == '-';
+      e++;
+    }
+    if (e < end && *e >= '0' && *e <= '9') {
+      int e_value = 0;
+      for (; e < end && *e >= '0' && *e <= '9'; e++) {
+        e_value = e_value < 10000 ? e_value * 10 + (*e - '0') : e_value;
+      }
+      exponent += e_negative ? -e_value : e_value;
+      p = e;
+    }
+  }
+
+  if (digits <= 15 && exponent >= -22 && exponent <= 22) {
+    double d = (double)mantissa;
+    d = exponent < 0 ? d / WKT_POW10[-exponent] : d * WKT_POW10[exponent];
+    *value = negative ? -d : d;
+    return true;
+  }
+
+  // strtod() needs a terminated copy, as the text may run on into the next
+  // coordinate
+  std::string number(start, p);
+  *value = std::strtod(number.c_str(), NULL);
+  return true;
+}
+
+// Reads one WKT geometry, encoding each of its points / lines / rings as it
+// goes. Polygons of a MULTIPOLYGON are separated by a split, as the sf
+// encoder does. Only the X and Y of each coordinate are encoded, at 10^-P degrees;
+// any Z and M values are skipped.
+template <int P>
+struct WktPolylineReader {
+
+  typedef typename PolylinePrecision<P>::coord_type coord_type;
+
+  const char* p;
+  const char* end;
+  EncodedPolylines* out;
+
+  WktPolylineReader() : p(NULL), end(NULL), out(NULL) {}
+
+  void skip_space() {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) {
+      p++;
+    }
+  }
+
+  bool expect(char c) {
+    skip_space();
+    if (p < end && *p == c) {
+      p++;
+      return true;
+    }
+    return false;
+  }
+
+  bool peek(char c) {
+    skip_space();
+    return p < end && *p == c;
+  }
+
+  // Reads a keyword, upper-cased
+  std::string word() {
+    skip_space();
+    std::string w;
+    for (; p < end && ((*p >= 'A' && *p <= 'Z') || (*p >= 'a' && *p <= 'z')); p++) {
+      w.push_back(*p >= 'a' ? *p - 'a' + 'A' : *p);
+    }
+    return w;
+  }
+
+  bool empty() {
+    const char* at = p;
+    if (word() == "EMPTY") {
+      return true;
+    }
+    p = at;
+    return false;
+  }
+
+  // Reads a coordinate and writes its deltas from the previous one
+  bool coordinate(char*& o, coord_type& plat, coord_type& plon) {
+    double lon, lat, extra;
+    skip_space();
+    if (!parse_wkt_double(p, end, &lon)) return false;
+    skip_space();
+    if (!parse_wkt_double(p, end, &lat)) return false;
+    skip_space();
+    while (p < end && *p != ',' && *p != ')') {
+      if (!parse_wkt_double(p, end, &extra)) return false;
+      skip_space();
+    }
+
+    o = write_coordinate<P>(o, lon, lat, plat, plon);
+    return true;
+  }
+
+  // ( x y, x y, ... ) as one polyline
+  bool linestring() {
+    if (empty()) return true;
+    if (!expect('(')) return false;
+
+    coord_type plat = 0;
+    coord_type plon = 0;
+    do {
+      char* o = out->reserve(max_encoded_size<P>(1));
+      if (!coordinate(o, plat, plon)) return false;
+      out->wrote(o);
+    } while (expect(','));
+
+    out->end_part();
+    return expect(')');
+  }
+
+  // ( linestring, linestring, ... )
+  bool linestrings() {
+    if (empty()) return true;
+    if (!expect('(')) return false;
+    do {
+      if (!linestring()) return false;
+    } while (expect(','));
+    return expect(')');
+  }
+
+  // ( (x y), (x y), ... ) or ( x y, x y, ... ), one polyline per point
+  bool points() {
+    if (empty()) return true;
+    if (!expect('(')) return false;
+    do {
+      if (peek('(') || peek('E') || peek('e')) {
+        if (!linestring()) return false;
+        continue;
+      }
+      char* o = out->reserve(max_encoded_size<P>(1));
+      coord_type plat = 0;
+      coord_type plon = 0;
+      if (!coordinate(o, plat, plon)) return false;
+      out->wrote(o);
+      out->end_part();
+    } while (expect(','));
+    return expect(')');
+  }
+
+  // ( polygon, polygon, ... ), split after each polygon
+  bool polygons() {
+    if (empty()) return true;
+    if (!expect('(')) return false;
+    do {
+      if (!linestrings()) return false;
+      out->split();
+    } while (expect(','));
+    return expect(')');
+  }
+
+  // Reads `wkt` onto the end of `polylines`, setting `type` to its geometry
+  // type. An unsupported type adds no polylines. Returns false if the text
+  // is not valid WKT.
+  bool read(const char* wkt, size_t len, EncodedPolylines& polylines, std::string& type) {
+
+    p = wkt;
+    end = wkt + len;
+    out = &polylines;
+    size_t first = polylines.parts();
+
+    type = word();
+
+    // dimension tag, e.g. POINT Z (...)
+    const char* at = p;
+    std::string dim = word();
+    if (dim != "Z" && dim != "M" && dim != "ZM") {
+      p = at;
+    }
+
+    bool ok;
+    if (type == "POINT") {
+      ok = linestring();
+    } else if (type == "MULTIPOINT") {
+      ok = points();
+    } else if (type == "LINESTRING") {
+      ok = linestring();
+    } else if (type == "MULTILINESTRING" || type == "POLYGON") {
+      ok = linestrings();
+    } else if (type == "MULTIPOLYGON") {
+      ok = polygons();
+    } else {
+      return true;
+    }
+
+    // a MULTIPOLYGON ending on an EMPTY polygon leaves two splits, so drop
+    // every trailing one rather than just the last
+    while (polylines.parts() > first && polylines.is_split(polylines.parts() - 1)) {
+      polylines.pop_split();
+    }
+
+    skip_space();
+    return ok && p == end;
+  }
+};
+
+#endif
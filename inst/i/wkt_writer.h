@@ -0,0 +1,111 @@
+#ifndef GOOGLEWKTWRITER_H
+#define GOOGLEWKTWRITER_H
+
+// Well-known text writer for decoded polylines. The coordinates come out of
+// the decoder as integer 10^-precision degrees, so they are written as fixed
+// point decimals straight from the integers: no floating point formatting, no
+// locale, and no trailing zeros.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// "-922337203685.4775808" is the longest int64 at 1e-7
+#define WKT_MAX_NUMBER_CHARS 21
+
+// ", " lon " " lat
+#define WKT_MAX_COORD_CHARS (2 * WKT_MAX_NUMBER_CHARS + 3)
+
+static const uint64_t WKT_POW10_INT[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000};
+
+// Writes value / 10^precision rounded (half away from zero) to `digits`
+// decimals, where digits <= precision
+inline char* write_fixed_decimal(char* out, int64_t value, int precision, int digits) {
+
+  bool negative = value < 0;
+  uint64_t v = negative ? 0 - (uint64_t)value : (uint64_t)value;
+
+  uint64_t scale = WKT_POW10_INT[precision - digits];
+  v = (v + scale / 2) / scale;
+
+  uint64_t unit = WKT_POW10_INT[digits];
+  uint64_t whole = v / unit;
+  uint64_t frac = v % unit;
+
+  if (negative && v != 0) {
+    *out++ = '-';
+  }
+
+  char tmp[WKT_MAX_NUMBER_CHARS];
+  int n = 0;
+  do {
+    tmp[n++] = (char)('0' + whole % 10);
+    whole /= 10;
+  } while (whole > 0);
+  while (n > 0) {
+    *out++ = tmp[--n];
+  }
+
+  if (frac != 0) {
+    // drop the trailing zeros, then write the remaining decimals
+    int width = digits;
+    while (frac % 10 == 0) {
+      frac /= 10;
+      width--;
+    }
+    *out++ = '.';
+    for (int i = width - 1; i >= 0; i--) {
+      out[i] = (char)('0' + frac % 10);
+      frac /= 10;
+    }
+    out += width;
+  }
+  return out;
+}
+
+// A growable char buffer the WKT of one geometry is written into
+struct WktWriter {
+
+  std::vector<char> buffer;
+  size_t size;
+  int precision;
+  int digits;
+
+  WktWriter(int precision, int digits) : size(0), precision(precision), digits(digits) {}
+
+  void clear() {
+    size = 0;
+  }
+
+  // Makes room for n more chars
+  void reserve(size_t n) {
+    if (buffer.size() < size + n) {
+      buffer.resize(std::max(buffer.size() * 2, size + n));
+    }
+  }
+
+  void write(const char* s) {
+    size_t n = std::strlen(s);
+    reserve(n);
+    std::memcpy(buffer.data() + size, s, n);
+    size += n;
+  }
+
+  // Writes one lon / lat pair, with its separator unless it is the first.
+  // The caller must have reserved WKT_MAX_COORD_CHARS.
+  void coordinate(size_t i, int64_t lon, int64_t lat) {
+    char* out = buffer.data() + size;
+    if (i > 0) {
+      *out++ = ',';
+      *out++ = ' ';
+    }
+    out = write_fixed_decimal(out, lon, precision, digits);
+    *out++ = ' ';
+    out = write_fixed_decimal(out, lat, precision, digits);
+    size = out - buffer.data();
+  }
+};
+
+#endif
@@ -10,97 +10,369 @@ Rcpp::Rostream<true>&  Rcpp::Rcout = Rcpp::Rcpp_cout_get();
 Rcpp::Rostream<false>& Rcpp::Rcerr = Rcpp::Rcpp_cerr_get();
 #endif
 
+// rcpp_encodeSfGeometryArrow
+SEXP rcpp_encodeSfGeometryArrow(Rcpp::List sfc, int precision, int threads);
+RcppExport SEXP _googlePolylines_rcpp_encodeSfGeometryArrow(SEXP sfcSEXP, SEXP precisionSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::List >::type sfc(sfcSEXP);
+    Rcpp::traits::input_parameter< int >::type precision(precisionSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(rcpp_encodeSfGeometryArrow(sfc, precision, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rcpp_decode_arrow
+Rcpp::List rcpp_decode_arrow(SEXP array_xptr, bool integer, int precision, int threads);
+RcppExport SEXP _googlePolylines_rcpp_decode_arrow(SEXP array_xptrSEXP, SEXP integerSEXP, SEXP precisionSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type array_xptr(array_xptrSEXP);
+    Rcpp::traits::input_parameter< bool >::type integer(integerSEXP);
+    Rcpp::traits::input_parameter< int >::type precision(precisionSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(rcpp_decode_arrow(array_xptr, integer, precision, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rcpp_decode_arrow_flat
+Rcpp::List rcpp_decode_arrow_flat(SEXP array_xptr, bool integer, int precision, int threads);
+RcppExport SEXP _googlePolylines_rcpp_decode_arrow_flat(SEXP array_xptrSEXP, SEXP integerSEXP, SEXP precisionSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type array_xptr(array_xptrSEXP);
+    Rcpp::traits::input_parameter< bool >::type integer(integerSEXP);
+    Rcpp::traits::input_parameter< int >::type precision(precisionSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(rcpp_decode_arrow_flat(array_xptr, integer, precision, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rcpp_decode_sfc
+Rcpp::List rcpp_decode_sfc(Rcpp::List encodedList, int precision);
+RcppExport SEXP _googlePolylines_rcpp_decode_sfc(SEXP encodedListSEXP, SEXP precisionSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::List >::type encodedList(encodedListSEXP);
+    Rcpp::traits::input_parameter< int >::type precision(precisionSEXP);
+    rcpp_result_gen = Rcpp::wrap(rcpp_decode_sfc(encodedList, precision));
+    return rcpp_result_gen;
+END_RCPP
+}
 // rcpp_encodeSfGeometry
-Rcpp::List rcpp_encodeSfGeometry(Rcpp::List sfc, bool strip);
-RcppExport SEXP _googlePolylines_rcpp_encodeSfGeometry(SEXP sfcSEXP, SEXP stripSEXP) {
+Rcpp::List rcpp_encodeSfGeometry(Rcpp::List sfc, bool strip, int precision, int threads, bool zm, int z_precision, int m_precision);
+RcppExport SEXP _googlePolylines_rcpp_encodeSfGeometry(SEXP sfcSEXP, SEXP stripSEXP, SEXP precisionSEXP, SEXP threadsSEXP, SEXP zmSEXP, SEXP z_precisionSEXP, SEXP m_precisionSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< Rcpp::List >::type sfc(sfcSEXP);
     Rcpp::traits::input_parameter< bool >::type strip(stripSEXP);
-    rcpp_result_gen = Rcpp::wrap(rcpp_encodeSfGeometry(sfc, strip));
+    Rcpp::traits::input_parameter< int >::type precision(precisionSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< bool >::type zm(zmSEXP);
+    Rcpp::traits::input_parameter< int >::type z_precision(z_precisionSEXP);
+    Rcpp::traits::input_parameter< int >::type m_precision(m_precisionSEXP);
+    rcpp_result_gen = Rcpp::wrap(rcpp_encodeSfGeometry(sfc, strip, precision, threads, zm, z_precision, m_precision));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rcpp_encodeSfGeometryColumnar
+Rcpp::List rcpp_encodeSfGeometryColumnar(Rcpp::List sfc, int precision, int threads);
+RcppExport SEXP _googlePolylines_rcpp_encodeSfGeometryColumnar(SEXP sfcSEXP, SEXP precisionSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::List >::type sfc(sfcSEXP);
+    Rcpp::traits::input_parameter< int >::type precision(precisionSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(rcpp_encodeSfGeometryColumnar(sfc, precision, threads));
     return rcpp_result_gen;
 END_RCPP
 }
 // rcpp_decode_polyline_list
-Rcpp::List rcpp_decode_polyline_list(Rcpp::List encodedList, std::string attribute);
-RcppExport SEXP _googlePolylines_rcpp_decode_polyline_list(SEXP encodedListSEXP, SEXP attributeSEXP) {
+Rcpp::List rcpp_decode_polyline_list(Rcpp::List encodedList, std::string attribute, bool integer, int precision, int threads);
+RcppExport SEXP _googlePolylines_rcpp_decode_polyline_list(SEXP encodedListSEXP, SEXP attributeSEXP, SEXP integerSEXP, SEXP precisionSEXP, SEXP threadsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< Rcpp::List >::type encodedList(encodedListSEXP);
     Rcpp::traits::input_parameter< std::string >::type attribute(attributeSEXP);
-    rcpp_result_gen = Rcpp::wrap(rcpp_decode_polyline_list(encodedList, attribute));
+    Rcpp::traits::input_parameter< bool >::type integer(integerSEXP);
+    Rcpp::traits::input_parameter< int >::type precision(precisionSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(rcpp_decode_polyline_list(encodedList, attribute, integer, precision, threads));
     return rcpp_result_gen;
 END_RCPP
 }
 // rcpp_decode_polyline
-Rcpp::List rcpp_decode_polyline(Rcpp::StringVector encodedStrings, Rcpp::String encoded_type);
-RcppExport SEXP _googlePolylines_rcpp_decode_polyline(SEXP encodedStringsSEXP, SEXP encoded_typeSEXP) {
+Rcpp::List rcpp_decode_polyline(Rcpp::StringVector encodedStrings, Rcpp::String encoded_type, bool integer, int precision, int threads);
+RcppExport SEXP _googlePolylines_rcpp_decode_polyline(SEXP encodedStringsSEXP, SEXP encoded_typeSEXP, SEXP integerSEXP, SEXP precisionSEXP, SEXP threadsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< Rcpp::StringVector >::type encodedStrings(encodedStringsSEXP);
     Rcpp::traits::input_parameter< Rcpp::String >::type encoded_type(encoded_typeSEXP);
-    rcpp_result_gen = Rcpp::wrap(rcpp_decode_polyline(encodedStrings, encoded_type));
+    Rcpp::traits::input_parameter< bool >::type integer(integerSEXP);
+    Rcpp::traits::input_parameter< int >::type precision(precisionSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(rcpp_decode_polyline(encodedStrings, encoded_type, integer, precision, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rcpp_decode_columnar
+Rcpp::List rcpp_decode_columnar(Rcpp::IntegerVector features, Rcpp::List columnar, bool integer, int precision, int threads);
+RcppExport SEXP _googlePolylines_rcpp_decode_columnar(SEXP featuresSEXP, SEXP columnarSEXP, SEXP integerSEXP, SEXP precisionSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type features(featuresSEXP);
+    Rcpp::traits::input_parameter< Rcpp::List >::type columnar(columnarSEXP);
+    Rcpp::traits::input_parameter< bool >::type integer(integerSEXP);
+    Rcpp::traits::input_parameter< int >::type precision(precisionSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(rcpp_decode_columnar(features, columnar, integer, precision, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rcpp_decode_polyline_flat
+Rcpp::List rcpp_decode_polyline_flat(SEXP encoded, bool integer, int precision, int threads);
+RcppExport SEXP _googlePolylines_rcpp_decode_polyline_flat(SEXP encodedSEXP, SEXP integerSEXP, SEXP precisionSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type encoded(encodedSEXP);
+    Rcpp::traits::input_parameter< bool >::type integer(integerSEXP);
+    Rcpp::traits::input_parameter< int >::type precision(precisionSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(rcpp_decode_polyline_flat(encoded, integer, precision, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rcpp_decode_columnar_flat
+Rcpp::List rcpp_decode_columnar_flat(Rcpp::IntegerVector features, Rcpp::List columnar, bool integer, int precision, int threads);
+RcppExport SEXP _googlePolylines_rcpp_decode_columnar_flat(SEXP featuresSEXP, SEXP columnarSEXP, SEXP integerSEXP, SEXP precisionSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type features(featuresSEXP);
+    Rcpp::traits::input_parameter< Rcpp::List >::type columnar(columnarSEXP);
+    Rcpp::traits::input_parameter< bool >::type integer(integerSEXP);
+    Rcpp::traits::input_parameter< int >::type precision(precisionSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(rcpp_decode_columnar_flat(features, columnar, integer, precision, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rcpp_decode_zm
+Rcpp::List rcpp_decode_zm(Rcpp::List zmList, int z_precision, int m_precision, int threads);
+RcppExport SEXP _googlePolylines_rcpp_decode_zm(SEXP zmListSEXP, SEXP z_precisionSEXP, SEXP m_precisionSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::List >::type zmList(zmListSEXP);
+    Rcpp::traits::input_parameter< int >::type z_precision(z_precisionSEXP);
+    Rcpp::traits::input_parameter< int >::type m_precision(m_precisionSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(rcpp_decode_zm(zmList, z_precision, m_precision, threads));
     return rcpp_result_gen;
 END_RCPP
 }
 // rcpp_encode_polyline
-std::string rcpp_encode_polyline(std::vector<double> longitude, std::vector<double> latitude);
-RcppExport SEXP _googlePolylines_rcpp_encode_polyline(SEXP longitudeSEXP, SEXP latitudeSEXP) {
+std::string rcpp_encode_polyline(Rcpp::NumericVector longitude, Rcpp::NumericVector latitude, int precision);
+RcppExport SEXP _googlePolylines_rcpp_encode_polyline(SEXP longitudeSEXP, SEXP latitudeSEXP, SEXP precisionSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< std::vector<double> >::type longitude(longitudeSEXP);
-    Rcpp::traits::input_parameter< std::vector<double> >::type latitude(latitudeSEXP);
-    rcpp_result_gen = Rcpp::wrap(rcpp_encode_polyline(longitude, latitude));
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type longitude(longitudeSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type latitude(latitudeSEXP);
+    Rcpp::traits::input_parameter< int >::type precision(precisionSEXP);
+    rcpp_result_gen = Rcpp::wrap(rcpp_encode_polyline(longitude, latitude, precision));
     return rcpp_result_gen;
 END_RCPP
 }
 // rcpp_encode_polyline_byrow
-std::vector<std::string> rcpp_encode_polyline_byrow(Rcpp::NumericVector longitude, Rcpp::NumericVector latitude);
-RcppExport SEXP _googlePolylines_rcpp_encode_polyline_byrow(SEXP longitudeSEXP, SEXP latitudeSEXP) {
+Rcpp::StringVector rcpp_encode_polyline_byrow(Rcpp::NumericVector longitude, Rcpp::NumericVector latitude, int precision, int threads);
+RcppExport SEXP _googlePolylines_rcpp_encode_polyline_byrow(SEXP longitudeSEXP, SEXP latitudeSEXP, SEXP precisionSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type longitude(longitudeSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type latitude(latitudeSEXP);
+    Rcpp::traits::input_parameter< int >::type precision(precisionSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(rcpp_encode_polyline_byrow(longitude, latitude, precision, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rcpp_encode_polyline_grouped
+Rcpp::StringVector rcpp_encode_polyline_grouped(Rcpp::NumericVector longitude, Rcpp::NumericVector latitude, Rcpp::IntegerVector group, int n_groups, int precision, int threads);
+RcppExport SEXP _googlePolylines_rcpp_encode_polyline_grouped(SEXP longitudeSEXP, SEXP latitudeSEXP, SEXP groupSEXP, SEXP n_groupsSEXP, SEXP precisionSEXP, SEXP threadsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< Rcpp::NumericVector >::type longitude(longitudeSEXP);
     Rcpp::traits::input_parameter< Rcpp::NumericVector >::type latitude(latitudeSEXP);
-    rcpp_result_gen = Rcpp::wrap(rcpp_encode_polyline_byrow(longitude, latitude));
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type group(groupSEXP);
+    Rcpp::traits::input_parameter< int >::type n_groups(n_groupsSEXP);
+    Rcpp::traits::input_parameter< int >::type precision(precisionSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(rcpp_encode_polyline_grouped(longitude, latitude, group, n_groups, precision, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rcpp_polyline_index
+Rcpp::IntegerMatrix rcpp_polyline_index(Rcpp::StringVector polylines, int every, int precision, int threads);
+RcppExport SEXP _googlePolylines_rcpp_polyline_index(SEXP polylinesSEXP, SEXP everySEXP, SEXP precisionSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::StringVector >::type polylines(polylinesSEXP);
+    Rcpp::traits::input_parameter< int >::type every(everySEXP);
+    Rcpp::traits::input_parameter< int >::type precision(precisionSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(rcpp_polyline_index(polylines, every, precision, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rcpp_polyline_slice
+Rcpp::List rcpp_polyline_slice(Rcpp::StringVector polylines, SEXP index, int every, Rcpp::IntegerVector from, Rcpp::IntegerVector to, int precision, int threads);
+RcppExport SEXP _googlePolylines_rcpp_polyline_slice(SEXP polylinesSEXP, SEXP indexSEXP, SEXP everySEXP, SEXP fromSEXP, SEXP toSEXP, SEXP precisionSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::StringVector >::type polylines(polylinesSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type index(indexSEXP);
+    Rcpp::traits::input_parameter< int >::type every(everySEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type from(fromSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type to(toSEXP);
+    Rcpp::traits::input_parameter< int >::type precision(precisionSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(rcpp_polyline_slice(polylines, index, every, from, to, precision, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rcpp_polyline_npoints
+Rcpp::IntegerVector rcpp_polyline_npoints(SEXP polylines, int threads);
+RcppExport SEXP _googlePolylines_rcpp_polyline_npoints(SEXP polylinesSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type polylines(polylinesSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(rcpp_polyline_npoints(polylines, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rcpp_polyline_bbox
+Rcpp::NumericMatrix rcpp_polyline_bbox(SEXP polylines, int precision, int threads);
+RcppExport SEXP _googlePolylines_rcpp_polyline_bbox(SEXP polylinesSEXP, SEXP precisionSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type polylines(polylinesSEXP);
+    Rcpp::traits::input_parameter< int >::type precision(precisionSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(rcpp_polyline_bbox(polylines, precision, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rcpp_wkb_to_polyline
+Rcpp::List rcpp_wkb_to_polyline(Rcpp::List wkb, int precision);
+RcppExport SEXP _googlePolylines_rcpp_wkb_to_polyline(SEXP wkbSEXP, SEXP precisionSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::List >::type wkb(wkbSEXP);
+    Rcpp::traits::input_parameter< int >::type precision(precisionSEXP);
+    rcpp_result_gen = Rcpp::wrap(rcpp_wkb_to_polyline(wkb, precision));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rcpp_polyline_to_wkb
+Rcpp::List rcpp_polyline_to_wkb(Rcpp::List sfencoded, bool big_endian, int precision);
+RcppExport SEXP _googlePolylines_rcpp_polyline_to_wkb(SEXP sfencodedSEXP, SEXP big_endianSEXP, SEXP precisionSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::List >::type sfencoded(sfencodedSEXP);
+    Rcpp::traits::input_parameter< bool >::type big_endian(big_endianSEXP);
+    Rcpp::traits::input_parameter< int >::type precision(precisionSEXP);
+    rcpp_result_gen = Rcpp::wrap(rcpp_polyline_to_wkb(sfencoded, big_endian, precision));
     return rcpp_result_gen;
 END_RCPP
 }
 // rcpp_polyline_to_wkt
-Rcpp::StringVector rcpp_polyline_to_wkt(Rcpp::List sfencoded);
-RcppExport SEXP _googlePolylines_rcpp_polyline_to_wkt(SEXP sfencodedSEXP) {
+Rcpp::StringVector rcpp_polyline_to_wkt(Rcpp::List sfencoded, int precision, int digits, int threads);
+RcppExport SEXP _googlePolylines_rcpp_polyline_to_wkt(SEXP sfencodedSEXP, SEXP precisionSEXP, SEXP digitsSEXP, SEXP threadsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< Rcpp::List >::type sfencoded(sfencodedSEXP);
-    rcpp_result_gen = Rcpp::wrap(rcpp_polyline_to_wkt(sfencoded));
+    Rcpp::traits::input_parameter< int >::type precision(precisionSEXP);
+    Rcpp::traits::input_parameter< int >::type digits(digitsSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(rcpp_polyline_to_wkt(sfencoded, precision, digits, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rcpp_columnar_to_wkt
+Rcpp::StringVector rcpp_columnar_to_wkt(Rcpp::IntegerVector features, Rcpp::List columnar, int precision, int digits, int threads);
+RcppExport SEXP _googlePolylines_rcpp_columnar_to_wkt(SEXP featuresSEXP, SEXP columnarSEXP, SEXP precisionSEXP, SEXP digitsSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type features(featuresSEXP);
+    Rcpp::traits::input_parameter< Rcpp::List >::type columnar(columnarSEXP);
+    Rcpp::traits::input_parameter< int >::type precision(precisionSEXP);
+    Rcpp::traits::input_parameter< int >::type digits(digitsSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(rcpp_columnar_to_wkt(features, columnar, precision, digits, threads));
     return rcpp_result_gen;
 END_RCPP
 }
 // rcpp_wkt_to_polyline
-Rcpp::List rcpp_wkt_to_polyline(Rcpp::StringVector wkt);
-RcppExport SEXP _googlePolylines_rcpp_wkt_to_polyline(SEXP wktSEXP) {
+Rcpp::List rcpp_wkt_to_polyline(Rcpp::StringVector wkt, int precision, int threads);
+RcppExport SEXP _googlePolylines_rcpp_wkt_to_polyline(SEXP wktSEXP, SEXP precisionSEXP, SEXP threadsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< Rcpp::StringVector >::type wkt(wktSEXP);
-    rcpp_result_gen = Rcpp::wrap(rcpp_wkt_to_polyline(wkt));
+    Rcpp::traits::input_parameter< int >::type precision(precisionSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(rcpp_wkt_to_polyline(wkt, precision, threads));
     return rcpp_result_gen;
 END_RCPP
 }
 
 static const R_CallMethodDef CallEntries[] = {
-    {"_googlePolylines_rcpp_encodeSfGeometry", (DL_FUNC) &_googlePolylines_rcpp_encodeSfGeometry, 2},
-    {"_googlePolylines_rcpp_decode_polyline_list", (DL_FUNC) &_googlePolylines_rcpp_decode_polyline_list, 2},
-    {"_googlePolylines_rcpp_decode_polyline", (DL_FUNC) &_googlePolylines_rcpp_decode_polyline, 2},
-    {"_googlePolylines_rcpp_encode_polyline", (DL_FUNC) &_googlePolylines_rcpp_encode_polyline, 2},
-    {"_googlePolylines_rcpp_encode_polyline_byrow", (DL_FUNC) &_googlePolylines_rcpp_encode_polyline_byrow, 2},
-    {"_googlePolylines_rcpp_polyline_to_wkt", (DL_FUNC) &_googlePolylines_rcpp_polyline_to_wkt, 1},
-    {"_googlePolylines_rcpp_wkt_to_polyline", (DL_FUNC) &_googlePolylines_rcpp_wkt_to_polyline, 1},
+    {"_googlePolylines_rcpp_encodeSfGeometryArrow", (DL_FUNC) &_googlePolylines_rcpp_encodeSfGeometryArrow, 3},
+    {"_googlePolylines_rcpp_decode_arrow", (DL_FUNC) &_googlePolylines_rcpp_decode_arrow, 4},
+    {"_googlePolylines_rcpp_decode_arrow_flat", (DL_FUNC) &_googlePolylines_rcpp_decode_arrow_flat, 4},
+    {"_googlePolylines_rcpp_decode_sfc", (DL_FUNC) &_googlePolylines_rcpp_decode_sfc, 2},
+    {"_googlePolylines_rcpp_encodeSfGeometry", (DL_FUNC) &_googlePolylines_rcpp_encodeSfGeometry, 7},
+    {"_googlePolylines_rcpp_encodeSfGeometryColumnar", (DL_FUNC) &_googlePolylines_rcpp_encodeSfGeometryColumnar, 3},
+    {"_googlePolylines_rcpp_decode_polyline_list", (DL_FUNC) &_googlePolylines_rcpp_decode_polyline_list, 5},
+    {"_googlePolylines_rcpp_decode_polyline", (DL_FUNC) &_googlePolylines_rcpp_decode_polyline, 5},
+    {"_googlePolylines_rcpp_decode_columnar", (DL_FUNC) &_googlePolylines_rcpp_decode_columnar, 5},
+    {"_googlePolylines_rcpp_decode_polyline_flat", (DL_FUNC) &_googlePolylines_rcpp_decode_polyline_flat, 4},
+    {"_googlePolylines_rcpp_decode_columnar_flat", (DL_FUNC) &_googlePolylines_rcpp_decode_columnar_flat, 5},
+    {"_googlePolylines_rcpp_decode_zm", (DL_FUNC) &_googlePolylines_rcpp_decode_zm, 4},
+    {"_googlePolylines_rcpp_encode_polyline", (DL_FUNC) &_googlePolylines_rcpp_encode_polyline, 3},
+    {"_googlePolylines_rcpp_encode_polyline_byrow", (DL_FUNC) &_googlePolylines_rcpp_encode_polyline_byrow, 4},
+    {"_googlePolylines_rcpp_encode_polyline_grouped", (DL_FUNC) &_googlePolylines_rcpp_encode_polyline_grouped, 6},
+    {"_googlePolylines_rcpp_polyline_index", (DL_FUNC) &_googlePolylines_rcpp_polyline_index, 4},
+    {"_googlePolylines_rcpp_polyline_slice", (DL_FUNC) &_googlePolylines_rcpp_polyline_slice, 7},
+    {"_googlePolylines_rcpp_polyline_npoints", (DL_FUNC) &_googlePolylines_rcpp_polyline_npoints, 2},
+    {"_googlePolylines_rcpp_polyline_bbox", (DL_FUNC) &_googlePolylines_rcpp_polyline_bbox, 3},
+    {"_googlePolylines_rcpp_wkb_to_polyline", (DL_FUNC) &_googlePolylines_rcpp_wkb_to_polyline, 2},
+    {"_googlePolylines_rcpp_polyline_to_wkb", (DL_FUNC) &_googlePolylines_rcpp_polyline_to_wkb, 3},
+    {"_googlePolylines_rcpp_polyline_to_wkt", (DL_FUNC) &_googlePolylines_rcpp_polyline_to_wkt, 4},
+    {"_googlePolylines_rcpp_columnar_to_wkt", (DL_FUNC) &_googlePolylines_rcpp_columnar_to_wkt, 5},
+    {"_googlePolylines_rcpp_wkt_to_polyline", (DL_FUNC) &_googlePolylines_rcpp_wkt_to_polyline, 3},
     {NULL, NULL, 0}
 };
 
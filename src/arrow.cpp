@@ -0,0 +1,235 @@
+#include <Rcpp.h>
+
+#include <cstdlib>
+
+#include "googlePolylines.h"
+#include "arrow_c.h"
+
+using namespace Rcpp;
+
+// Arrays are passed around R as nanoarrow does: external pointers classed
+// "nanoarrow_schema" and "nanoarrow_array", the array carrying its schema as
+// the pointer's tag. The structs are malloc()ed and released, if they still
+// own anything, when the pointer is garbage collected.
+
+void finalize_arrow_schema_xptr(SEXP xptr) {
+  ArrowSchema* schema = (ArrowSchema*)R_ExternalPtrAddr(xptr);
+  if (schema != NULL) {
+    if (schema->release != NULL) {
+      schema->release(schema);
+    }
+    free(schema);
+  }
+}
+
+void finalize_arrow_array_xptr(SEXP xptr) {
+  ArrowArray* array = (ArrowArray*)R_ExternalPtrAddr(xptr);
+  if (array != NULL) {
+    if (array->release != NULL) {
+      array->release(array);
+    }
+    free(array);
+  }
+}
+
+SEXP new_arrow_schema_xptr() {
+  ArrowSchema* schema = (ArrowSchema*)malloc(sizeof(ArrowSchema));
+  if (schema == NULL) {
+    Rcpp::stop("failed to allocate an ArrowSchema");
+  }
+  schema->release = NULL;
+
+  SEXP xptr = PROTECT(R_MakeExternalPtr(schema, R_NilValue, R_NilValue));
+  R_RegisterCFinalizer(xptr, &finalize_arrow_schema_xptr);
+  Rf_setAttrib(xptr, R_ClassSymbol, Rf_mkString("nanoarrow_schema"));
+  UNPROTECT(1);
+  return xptr;
+}
+
+SEXP new_arrow_array_xptr(SEXP schema_xptr) {
+  ArrowArray* array = (ArrowArray*)malloc(sizeof(ArrowArray));
+  if (array == NULL) {
+    Rcpp::stop("failed to allocate an ArrowArray");
+  }
+  array->release = NULL;
+
+  SEXP xptr = PROTECT(R_MakeExternalPtr(array, schema_xptr, R_NilValue));
+  R_RegisterCFinalizer(xptr, &finalize_arrow_array_xptr);
+  Rf_setAttrib(xptr, R_ClassSymbol, Rf_mkString("nanoarrow_array"));
+  UNPROTECT(1);
+  return xptr;
+}
+
+// Encodes an sfc straight into an Arrow list<list<utf8>>, nested as the
+// columnar layout is: geometries hold parts, which hold polylines. The
+// polylines are large_utf8 if they don't fit 32 bit offsets.
+// [[Rcpp::export]]
+SEXP rcpp_encodeSfGeometryArrow(Rcpp::List sfc, int precision, int threads) {
+
+  ColumnarRuns columnar;
+  encode_columnar(sfc, precision, threads, columnar);
+
+  if (columnar.n_polylines > INT32_MAX || columnar.part_offsets.size() > INT32_MAX) {
+    Rcpp::stop("too many polylines for an Arrow list array");
+  }
+  bool large = columnar.size() > INT32_MAX;
+
+  SEXP schema_xptr = PROTECT(new_arrow_schema_xptr());
+  SEXP array_xptr = PROTECT(new_arrow_array_xptr(schema_xptr));
+  ArrowSchema* schema = (ArrowSchema*)R_ExternalPtrAddr(schema_xptr);
+  ArrowArray* array = (ArrowArray*)R_ExternalPtrAddr(array_xptr);
+
+  init_arrow_schema(schema, "+l", "");
+  ArrowSchema* part_schema = add_arrow_schema_child(schema, "+l", "item");
+  add_arrow_schema_child(part_schema, large ? "U" : "u", "item");
+
+  ArrowArrayData* geoms = init_arrow_array(array, sfc.size());
+  geoms->offsets32.assign(columnar.geom_offsets.begin(), columnar.geom_offsets.end());
+  set_arrow_buffers(array, false, false);
+
+  ArrowArray* parts = add_arrow_array_child(array, columnar.part_offsets.size() - 1);
+  ArrowArrayData* part_data = (ArrowArrayData*)parts->private_data;
+  part_data->offsets32.assign(columnar.part_offsets.begin(), columnar.part_offsets.end());
+  set_arrow_buffers(parts, false, false);
+
+  ArrowArray* polylines = add_arrow_array_child(parts, columnar.n_polylines);
+  ArrowArrayData* polyline_data = (ArrowArrayData*)polylines->private_data;
+  polyline_data->data.resize(columnar.size());
+  if (large) {
+    polyline_data->offsets64.resize(columnar.n_polylines + 1);
+    columnar.copy(polyline_data->data.data(), polyline_data->offsets64.data(), threads);
+  } else {
+    polyline_data->offsets32.resize(columnar.n_polylines + 1);
+    columnar.copy(polyline_data->data.data(), polyline_data->offsets32.data(), threads);
+  }
+  set_arrow_buffers(polylines, large, true);
+
+  UNPROTECT(2);
+  return array_xptr;
+}
+
+// The schema and array of a nanoarrow_array that still owns its data
+void arrow_pointers(SEXP array_xptr, ArrowSchema** schema, ArrowArray** array) {
+
+  if (TYPEOF(array_xptr) != EXTPTRSXP || !Rf_inherits(array_xptr, "nanoarrow_array")) {
+    Rcpp::stop("expecting a nanoarrow_array");
+  }
+  SEXP schema_xptr = R_ExternalPtrTag(array_xptr);
+  if (TYPEOF(schema_xptr) != EXTPTRSXP) {
+    Rcpp::stop("the nanoarrow_array has no schema");
+  }
+
+  *schema = (ArrowSchema*)R_ExternalPtrAddr(schema_xptr);
+  *array = (ArrowArray*)R_ExternalPtrAddr(array_xptr);
+  if (*schema == NULL || *array == NULL || (*schema)->release == NULL || (*array)->release == NULL) {
+    Rcpp::stop("the Arrow array has been released");
+  }
+}
+
+void check_arrow_array(const ArrowArray* array, int64_t n_buffers, int64_t n_children,
+                       int64_t from, int64_t to) {
+  if (array->n_buffers != n_buffers || array->n_children != n_children ||
+      from < 0 || to > array->length) {
+    Rcpp::stop("invalid Arrow array");
+  }
+}
+
+// Appends the polylines of elements [from, to) of `array` to `views`,
+// through any lists down to the strings. Null strings are NA polylines and
+// null lists have none. The buffers are read in place.
+void arrow_views(const ArrowSchema* schema, const ArrowArray* array, int64_t from, int64_t to,
+                 std::vector< PolylineView >& views) {
+
+  ArrowPolylineType type = arrow_polyline_type(schema);
+  bool large = type == ARROW_LARGE_UTF8 || type == ARROW_LARGE_LIST;
+  int64_t start, end;
+
+  switch (type) {
+  case ARROW_UTF8:
+  case ARROW_LARGE_UTF8: {
+    check_arrow_array(array, 3, 0, from, to);
+    const char* data = (const char*)array->buffers[2];
+    for (int64_t i = from + array->offset; i < to + array->offset; i++) {
+      PolylineView view = {NULL, 0, true};
+      if (arrow_valid(array, i)) {
+        arrow_offsets(array, large, i, &start, &end);
+        view.encoded = data == NULL ? "" : data + start;
+        view.len = end - start;
+        view.na = false;
+      }
+      views.push_back(view);
+    }
+    break;
+  }
+  case ARROW_LIST:
+  case ARROW_LARGE_LIST: {
+    check_arrow_array(array, 2, 1, from, to);
+    for (int64_t i = from + array->offset; i < to + array->offset; i++) {
+      if (arrow_valid(array, i)) {
+        arrow_offsets(array, large, i, &start, &end);
+        arrow_views(schema->children[0], array->children[0], start, end, views);
+      }
+    }
+    break;
+  }
+  default:
+    Rcpp::stop("decoding Arrow arrays of type '%s' is not supported", schema->format);
+  }
+}
+
+// The polylines of every element of an array, element i being views
+// [offsets[i], offsets[i + 1])
+void arrow_elements(SEXP array_xptr, std::vector< PolylineView >& views, std::vector< size_t >& offsets) {
+
+  ArrowSchema* schema;
+  ArrowArray* array;
+  arrow_pointers(array_xptr, &schema, &array);
+
+  offsets.assign(array->length + 1, 0);
+  for (int64_t i = 0; i < array->length; i++) {
+    arrow_views(schema, array, i, i + 1, views);
+    offsets[i + 1] = views.size();
+  }
+}
+
+// A utf8 array decodes as a character vector does, to one data.frame per
+// string. A list array decodes as an encoded_column does, to a list of
+// data.frames per element.
+// [[Rcpp::export]]
+Rcpp::List rcpp_decode_arrow(SEXP array_xptr, bool integer, int precision, int threads) {
+
+  std::vector< PolylineView > views;
+  std::vector< size_t > offsets;
+  arrow_elements(array_xptr, views, offsets);
+
+  ArrowSchema* schema = (ArrowSchema*)R_ExternalPtrAddr(R_ExternalPtrTag(array_xptr));
+  ArrowPolylineType type = arrow_polyline_type(schema);
+
+  if (type == ARROW_UTF8 || type == ARROW_LARGE_UTF8) {
+    std::vector< std::vector<std::string> > col_headers(1, get_col_headers("XY"));
+    std::vector< size_t > header_index(views.size(), 0);
+    return decode_views(views, col_headers, header_index, integer, precision, threads);
+  }
+  return decode_grouped_views(views, offsets, integer, precision, threads);
+}
+
+// The flat decode() of an Arrow array, with each element an id and its
+// polylines the parts
+// [[Rcpp::export]]
+Rcpp::List rcpp_decode_arrow_flat(SEXP array_xptr, bool integer, int precision, int threads) {
+
+  std::vector< PolylineView > views;
+  std::vector< size_t > offsets;
+  arrow_elements(array_xptr, views, offsets);
+
+  std::vector< int > ids(views.size());
+  std::vector< int > part_ids(views.size());
+  for (size_t i = 0; i + 1 < offsets.size(); i++) {
+    for (size_t k = offsets[i]; k < offsets[i + 1]; k++) {
+      ids[k] = i + 1;
+      part_ids[k] = k - offsets[i] + 1;
+    }
+  }
+
+  return decode_views_flat(views, ids, part_ids, integer, precision, threads);
+}
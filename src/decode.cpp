@@ -0,0 +1,191 @@
+#include <Rcpp.h>
+
+#include "googlePolylines.h"
+#include "decoder.h"
+
+using namespace Rcpp;
+
+// Running bounding box of the decoded coordinates, as xmin, ymin, xmax, ymax
+void update_bbox(double* bbox, const double* lon, const double* lat, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    bbox[0] = std::min(bbox[0], lon[i]);
+    bbox[1] = std::min(bbox[1], lat[i]);
+    bbox[2] = std::max(bbox[2], lon[i]);
+    bbox[3] = std::max(bbox[3], lat[i]);
+  }
+}
+
+// Decodes polylines [from, to) into the rows of one n x 2 lon / lat matrix,
+// which is what a LINESTRING or a MULTIPOINT (one polyline per point) is
+Rcpp::NumericMatrix decode_matrix(std::vector< PolylineView >& views, size_t from, size_t to,
+                                  double* bbox, int precision) {
+
+  std::vector< size_t > sizes(to - from);
+  size_t n = 0;
+
+  for (size_t i = from; i < to; i++) {
+    if (views[i].na || !polyline_size(views[i].encoded, views[i].len, &sizes[i - from])) {
+      Rcpp::stop("invalid encoded polyline");
+    }
+    n += sizes[i - from];
+  }
+
+  Rcpp::NumericMatrix mat(n, 2);
+  double* lon = REAL(mat);
+  double* lat = lon + n;
+
+  size_t row = 0;
+  for (size_t i = from; i < to; i++) {
+    decode_polyline_into(views[i].encoded, views[i].len, lat + row, lon + row, precision);
+    row += sizes[i - from];
+  }
+  update_bbox(bbox, lon, lat, n);
+
+  return mat;
+}
+
+// Decodes polylines [from, to) into a list of matrices, one per polyline,
+// stopping at the first SPLIT_CHAR. Returns the index it stopped at.
+size_t decode_matrix_list(std::vector< PolylineView >& views, size_t from, size_t to,
+                          Rcpp::List& lst, double* bbox, int precision) {
+
+  size_t end = from;
+  while (end < to && !is_split(views[end])) {
+    end++;
+  }
+
+  lst = Rcpp::List(end - from);
+  for (size_t i = from; i < end; i++) {
+    lst[i - from] = decode_matrix(views, i, i + 1, bbox, precision);
+  }
+  return end;
+}
+
+// Rebuilds one sfg of type `cls` from its encoded polylines. The inverse of
+// write_data(): polygons are separated by SPLIT_CHAR, and every point of a
+// MULTIPOINT is its own polyline.
+SEXP decode_data(std::vector< PolylineView >& views, double* bbox, int precision, const char *cls) {
+
+  int tp;
+  make_type(cls, &tp);
+
+  size_t n = views.size();
+
+  switch(tp) {
+  case SF_Point: {
+    if (n == 0) {
+      return Rcpp::NumericVector::create(NA_REAL, NA_REAL);
+    }
+    Rcpp::NumericMatrix mat = decode_matrix(views, 0, n, bbox, precision);
+    if (mat.nrow() != 1) {
+      Rcpp::stop("a POINT must encode exactly one coordinate");
+    }
+    return Rcpp::NumericVector::create(mat[0], mat[1]);
+  }
+  case SF_MultiPoint:
+  case SF_LineString: {
+    return decode_matrix(views, 0, n, bbox, precision);
+  }
+  case SF_MultiLineString: {
+    Rcpp::List lst(n);
+    for (size_t i = 0; i < n; i++) {
+      lst[i] = decode_matrix(views, i, i + 1, bbox, precision);
+    }
+    return lst;
+  }
+  case SF_Polygon: {
+    Rcpp::List lst;
+    decode_matrix_list(views, 0, n, lst, bbox, precision);
+    return lst;
+  }
+  case SF_MultiPolygon: {
+    std::vector< Rcpp::List > polygons;
+    size_t i = 0;
+    while (i < n) {
+      Rcpp::List lst;
+      i = decode_matrix_list(views, i, n, lst, bbox, precision) + 1;
+      polygons.push_back(lst);
+    }
+    Rcpp::List out(polygons.size());
+    for (size_t j = 0; j < polygons.size(); j++) {
+      out[j] = polygons[j];
+    }
+    return out;
+  }
+  default: {
+    Rcpp::stop("decoding this sf type is currently not supported");
+  }
+  }
+  return R_NilValue;
+}
+
+// [[Rcpp::export]]
+Rcpp::List rcpp_decode_sfc(Rcpp::List encodedList, int precision) {
+
+  R_xlen_t n = encodedList.size();
+  Rcpp::List sfc(n);
+
+  double bbox[4] = {R_PosInf, R_PosInf, R_NegInf, R_NegInf};
+  int n_empty = 0;
+  std::string sfc_type;
+  std::vector< PolylineView > views;
+
+  for (R_xlen_t i = 0; i < n; i++) {
+
+    SEXP polylines = encodedList[i];
+    Rcpp::RObject sfg_attr = Rf_getAttrib(polylines, Rf_install("sfc"));
+    if (TYPEOF(polylines) != STRSXP || sfg_attr.isNULL()) {
+      Rcpp::stop("the encoded polylines need their 'sfc' attribute, i.e. encode(..., strip = FALSE)");
+    }
+    Rcpp::CharacterVector sfg_cls(sfg_attr);
+
+    R_xlen_t pn = Rf_xlength(polylines);
+    views.resize(pn);
+    for (R_xlen_t j = 0; j < pn; j++) {
+      views[j] = polyline_view(STRING_ELT(polylines, j));
+    }
+
+    // only the XY coordinates are encoded
+    SEXP sfg = PROTECT(decode_data(views, bbox, precision, sfg_cls[1]));
+    Rf_setAttrib(sfg, R_ClassSymbol,
+                 Rcpp::CharacterVector::create("XY", sfg_cls[1], "sfg"));
+    sfc[i] = sfg;
+    UNPROTECT(1);
+
+    n_empty += pn == 0;
+
+    std::string type = Rcpp::as< std::string >(sfg_cls[1]);
+    if (i == 0) {
+      sfc_type = type;
+    } else if (sfc_type != type) {
+      sfc_type = "GEOMETRY";
+    }
+  }
+
+  if (n == 0) {
+    sfc_type = "GEOMETRY";
+  }
+
+  // no coordinates at all
+  if (bbox[0] > bbox[2]) {
+    std::fill(bbox, bbox + 4, NA_REAL);
+  }
+
+  Rcpp::NumericVector sfc_bbox(bbox, bbox + 4);
+  sfc_bbox.attr("names") = Rcpp::CharacterVector::create("xmin", "ymin", "xmax", "ymax");
+  sfc_bbox.attr("class") = "bbox";
+
+  Rcpp::List crs = Rcpp::List::create(
+    _["input"] = NA_STRING,
+    _["wkt"] = NA_STRING
+  );
+  crs.attr("class") = "crs";
+
+  sfc.attr("class") = Rcpp::CharacterVector::create("sfc_" + sfc_type, "sfc");
+  sfc.attr("precision") = 0.0;
+  sfc.attr("bbox") = sfc_bbox;
+  sfc.attr("crs") = crs;
+  sfc.attr("n_empty") = n_empty;
+
+  return sfc;
+}
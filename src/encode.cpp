@@ -1,6 +1,8 @@
 #include <Rcpp.h>
 using namespace Rcpp;
+#include <climits>
 #include "googlePolylines.h"
+#include "threads.h"
 
 template <int RTYPE>
 Rcpp::CharacterVector sfClass(Vector<RTYPE> v) {
@@ -22,25 +24,18 @@ Rcpp::CharacterVector getSfClass(SEXP sf) {
 }
 
 
-template<typename Out>
-void split(const std::string &s, char delim, Out result) {
-  std::stringstream ss(s);
-  std::string item;
-  while (std::getline(ss, item, delim)) {
-    *(result++) = item;
-  }
-}
-
-void split(const std::string &s, char delim) {
-  global_vars::elems.clear();
-  split(s, delim, std::back_inserter(global_vars::elems));
-}
-
-
-void write_data(std::ostringstream& os, std::ostringstream& oszm, Rcpp::CharacterVector& sfg_dim, int dim_divisor, 
+void write_data(PolylineEncoder& enc, Rcpp::CharacterVector& sfg_dim, int dim_divisor, 
                 SEXP sfc, const char *cls, int srid);
 
-void write_matrix_list(std::ostringstream& os, std::ostringstream& oszm, Rcpp::List lst, Rcpp::CharacterVector& sfg_dim, int dim_divisor);
+void write_matrix_list(PolylineEncoder& enc, Rcpp::List lst, Rcpp::CharacterVector& sfg_dim, int dim_divisor);
+
+// Adds the Z and M of the polyline just encoded to the ZM stream, if it is
+// being written and the geometry has them
+void add_zm(PolylineEncoder& enc, const double* lons, const double* lats, size_t n) {
+  if (enc.zm && !enc.zm_stream.empty() && !add_zm_polyline(enc.zm_polylines, enc.zm_stream, lons, lats, n)) {
+    Rcpp::stop("Z and M values must be finite or NA");
+  }
+}
 
 void make_dim_divisor(const char *cls, int *d) {
   int divisor = 2;
@@ -57,8 +52,8 @@ void make_dim_divisor(const char *cls, int *d) {
   *d = divisor;
 }
 
-void make_type(const char *cls, int *tp = NULL,
-                       int srid = 0) {
+void make_type(const char *cls, int *tp,
+                       int srid) {
   int type = 0;
   if (strstr(cls, "sfc_") == cls)
     cls += 4;
@@ -86,73 +81,34 @@ void make_type(const char *cls, int *tp = NULL,
   //return type;
 }
 
-void write_multipolygon(std::ostringstream& os, std::ostringstream& oszm, Rcpp::List lst, Rcpp::CharacterVector& sfg_dim, int dim_divisor) {
+void write_multipolygon(PolylineEncoder& enc, Rcpp::List lst, Rcpp::CharacterVector& sfg_dim, int dim_divisor) {
   
   for (int i = 0; i < lst.length(); i++) {
-    write_matrix_list(os, oszm, lst[i], sfg_dim, dim_divisor);
+    write_matrix_list(enc, lst[i], sfg_dim, dim_divisor);
   }
 }
 
-void addToStream(std::ostringstream& os) {
-  os << global_vars::encodedString << ' ';
-}
-
-void encode_point( std::ostringstream& os, std::ostringstream& oszm, Rcpp::NumericVector point, Rcpp::CharacterVector& sfg_dim, int dim_divisor) {
-  
-  global_vars::lons.clear();
-  global_vars::lats.clear();
-  global_vars::lons.push_back(point[0]);
-  global_vars::lats.push_back(point[1]);
-  
-  global_vars::encodedString = encode_polyline();
-  addToStream(os);
-  
-  // if ( dim_divisor > 2 ) {
-  //   Rcpp::NumericVector elev(1);
-  //   Rcpp::NumericVector meas(1);
-  //   
-  //   elev[0] = point[2];
-  //   if (dim_divisor == 4 ) {
-  //     meas[0] = point[3];
-  //   }
-  //   
-  //   encodedString = encode_polyline(elev, meas);
-  //   addToStream(oszm, encodedString);
-  // }
+void encode_point( PolylineEncoder& enc, Rcpp::NumericVector point, Rcpp::CharacterVector& sfg_dim, int dim_divisor) {
   
+  const double* coords = REAL(point);
+  add_polyline(enc.polylines, enc.precision, coords, coords + 1, 1);
+  add_zm(enc, coords, coords + 1, 1);
 }
 
-void encode_points( std::ostringstream& os, std::ostringstream& oszm, Rcpp::NumericMatrix point, 
+void encode_points( PolylineEncoder& enc, Rcpp::NumericMatrix point, 
                     Rcpp::CharacterVector& sfg_dim, int dim_divisor) {
   
   int n = point.size() / dim_divisor;
-  global_vars::lons.clear();
-  global_vars::lons.resize(1);
-  global_vars::lats.clear();
-  global_vars::lats.resize(1);
-  
-  //Rcpp::NumericVector elev(1);
-  //Rcpp::NumericVector meas(1);
+  const double* coords = REAL(point);
   
   for (int i = 0; i < n; i++){
-    global_vars::lons[0] = point(i, 0);
-    global_vars::lats[0] = point(i, 1);
-    global_vars::encodedString = encode_polyline();
-    addToStream(os);
-    
-    // if ( dim_divisor > 2 ) {
-    //   elev[0] = point(i, 2);
-    //   meas[0] = dim_divisor == 4 ? point(i, 3) : 0;
-    //   
-    //   encodedString = encode_polyline( elev, meas );
-    //   addToStream(oszm, encodedString);
-    // }
-    
+    add_polyline(enc.polylines, enc.precision, coords + i, coords + i + n, 1);
+    add_zm(enc, coords + i, coords + i + n, 1);
   }
   
 }
 
-void encode_vector( std::ostringstream& os, std::ostringstream& oszm, Rcpp::List vec, Rcpp::CharacterVector& sfg_dim,
+void encode_vector( PolylineEncoder& enc, Rcpp::NumericVector vec, Rcpp::CharacterVector& sfg_dim,
                     int dim_divisor) {
 
   // - XY == [0][1]
@@ -160,100 +116,58 @@ void encode_vector( std::ostringstream& os, std::ostringstream& oszm, Rcpp::List
   // - XYM == [0][1][2]{3}
   // - XYZM == [0][1][2][3]
   
+  // the coordinates are read straight from the column-major matrix
   int n = vec.size() / dim_divisor;
+  const double* coords = REAL(vec);
   
-  global_vars::lats.clear();
-  global_vars::lons.clear();
-  
-  for (int i = 0; i < n; i++) {
-    global_vars::lons.push_back(vec[i]);
-    global_vars::lats.push_back(vec[(i + n)]);
-  }
-  
-  global_vars::encodedString = encode_polyline();
-  addToStream(os);
-  
-  // if (dim_divisor > 2) {
-  //   // there are Z and M attributes to encode
-  //   // constructor sets them to 0
-  //   Rcpp::NumericVector elev(n);
-  //   Rcpp::NumericVector meas(n);
-  //   
-  //   for (int i = 0; i < n; i++) {
-  //     elev[i] = vec[(i + n + n)];
-  //     meas[i] = dim_divisor == 4 ? vec[(i + n + n + n)] : 0;
-  //   }
-  //   encodedString = encode_polyline(elev, meas);
-  //   addToStream(oszm, encodedString);
-  // }
-  
+  add_polyline(enc.polylines, enc.precision, coords, coords + n, n);
+  add_zm(enc, coords, coords + n, n);
 }
 
-void encode_vectors( std::ostringstream& os, std::ostringstream& oszm, Rcpp::List sfc, Rcpp::CharacterVector& sfg_dim,
+void encode_vectors( PolylineEncoder& enc, Rcpp::List sfc, Rcpp::CharacterVector& sfg_dim,
                      int dim_divisor){
   
   size_t n = sfc.size();
   
   for (size_t i = 0; i < n; i++) {
-    encode_vector(os, oszm, sfc[i], sfg_dim, dim_divisor);
+    encode_vector(enc, sfc[i], sfg_dim, dim_divisor);
   }
 }
 
-void encode_matrix(std::ostringstream& os, std::ostringstream& oszm, Rcpp::NumericMatrix mat, 
+void encode_matrix(PolylineEncoder& enc, Rcpp::NumericMatrix mat, 
                    Rcpp::CharacterVector& sfg_dim, int dim_divisor ) {
   
-  global_vars::lons.clear();
-  global_vars::lats.clear();
   int nrow = mat.nrow();
-  for (int i = 0; i < nrow; ++i) {
-    global_vars::lats.push_back(mat(i, 1));
-    global_vars::lons.push_back(mat(i, 0));
-  }
-  
-  global_vars::encodedString = encode_polyline();
-  addToStream(os);
-  
-  // if (dim_divisor > 2 ) {
-  //   int n = mat.size() / dim_divisor;
-  //   Rcpp::NumericVector elev(n);
-  //   Rcpp::NumericVector meas(n);
-  //   if( dim_divisor == 3 ) {
-  //     elev = mat(_, 2);
-  //   } else if ( dim_divisor == 4 ) { 
-  //     elev = mat(_, 2);
-  //     meas = mat(_, 3);
-  //   }
-  //   encodedString = encode_polyline(elev, meas);
-  //   addToStream(oszm, encodedString);
-  // }
+  const double* coords = REAL(mat);
   
+  add_polyline(enc.polylines, enc.precision, coords, coords + nrow, nrow);
+  add_zm(enc, coords, coords + nrow, nrow);
 }
 
-void write_matrix_list(std::ostringstream& os, std::ostringstream& oszm, Rcpp::List lst, 
+void write_matrix_list(PolylineEncoder& enc, Rcpp::List lst, 
                        Rcpp::CharacterVector& sfg_dim, int dim_divisor ) {
   
   size_t len = lst.length();
    
   for (size_t j = 0; j < len; j++){
-     encode_matrix(os, oszm, lst[j], sfg_dim, dim_divisor);
+     encode_matrix(enc, lst[j], sfg_dim, dim_divisor);
   }
-  global_vars::encodedString = SPLIT_CHAR;
-  addToStream(os);
+  enc.polylines.split();
   
-  // if (dim_divisor > 2) {
-  //   addToStream(oszm, SPLIT_CHAR);
-  // }
+  if (enc.zm && !enc.zm_stream.empty()) {
+    enc.zm_polylines.split();
+  }
 }
 
-void write_geometry(std::ostringstream& os, std::ostringstream& oszm, SEXP s, 
+void write_geometry(PolylineEncoder& enc, SEXP s, 
                     Rcpp::CharacterVector& sfg_dim, int dim_divisor) {
   
   Rcpp::CharacterVector cls_attr = getSfClass(s);
   
-  write_data(os, oszm, sfg_dim, dim_divisor, s, cls_attr[1], 0);
+  write_data(enc, sfg_dim, dim_divisor, s, cls_attr[1], 0);
 }
 
-void write_data(std::ostringstream& os, std::ostringstream& oszm, Rcpp::CharacterVector& sfg_dim, int dim_divisor, 
+void write_data(PolylineEncoder& enc, Rcpp::CharacterVector& sfg_dim, int dim_divisor, 
                 SEXP sfc, const char *cls = NULL, int srid = 0) {
   
   int tp;
@@ -261,25 +175,25 @@ void write_data(std::ostringstream& os, std::ostringstream& oszm, Rcpp::Characte
   
   switch(tp) {
   case SF_Point:
-    encode_point(os, oszm, sfc, sfg_dim, dim_divisor);
+    encode_point(enc, sfc, sfg_dim, dim_divisor);
     break;
   case SF_MultiPoint:
-    encode_points(os, oszm, sfc, sfg_dim, dim_divisor);
+    encode_points(enc, sfc, sfg_dim, dim_divisor);
     break;
   case SF_LineString:
-    encode_vector(os, oszm, sfc, sfg_dim, dim_divisor);
+    encode_vector(enc, sfc, sfg_dim, dim_divisor);
     break;
   case SF_MultiLineString:
-    encode_vectors(os, oszm, sfc, sfg_dim, dim_divisor);
+    encode_vectors(enc, sfc, sfg_dim, dim_divisor);
     break;
   case SF_Polygon:
-    write_matrix_list(os, oszm, sfc, sfg_dim, dim_divisor);
+    write_matrix_list(enc, sfc, sfg_dim, dim_divisor);
     break;
   case SF_MultiPolygon:
-    write_multipolygon(os, oszm, sfc, sfg_dim, dim_divisor);
+    write_multipolygon(enc, sfc, sfg_dim, dim_divisor);
     break;
   case SF_Geometry:
-    write_geometry(os, oszm, sfc, sfg_dim, dim_divisor);
+    write_geometry(enc, sfc, sfg_dim, dim_divisor);
     break;
 //  case SF_GeometryCollection:
 //  	write_geometrycollection(os, sfc);
@@ -291,74 +205,349 @@ void write_data(std::ostringstream& os, std::ostringstream& oszm, Rcpp::Characte
   }
 }
 
+// Coordinates of an sfg as a double pointer. Non-double coordinates are
+// coerced and kept alive in `keep` until the encoding has finished.
+const double* coordinates(SEXP sfg, std::vector< Rcpp::NumericVector >& keep) {
+  if (TYPEOF(sfg) == REALSXP) {
+    return REAL(sfg);
+  }
+  keep.push_back(Rcpp::NumericVector(sfg));
+  return REAL(keep.back());
+}
+
+void gather_vector(std::vector< PolylinePart >& parts, std::vector< Rcpp::NumericVector >& keep,
+                   SEXP vec, int dim_divisor) {
+  size_t n = Rf_xlength(vec) / dim_divisor;
+  const double* p = coordinates(vec, keep);
+  parts.push_back({p, p + n, n, false});
+}
+
+void gather_matrix_list(std::vector< PolylinePart >& parts, std::vector< Rcpp::NumericVector >& keep,
+                        SEXP lst, int dim_divisor) {
+  R_xlen_t n = Rf_xlength(lst);
+  for (R_xlen_t i = 0; i < n; i++) {
+    gather_vector(parts, keep, VECTOR_ELT(lst, i), dim_divisor);
+  }
+  parts.push_back({NULL, NULL, 0, true});
+}
+
+// The R-touching half of write_data(): walks an sfg and records where each
+// polyline's coordinates live, in the same order write_data() encodes them.
+void gather_data(std::vector< PolylinePart >& parts, std::vector< Rcpp::NumericVector >& keep,
+                 SEXP sfg, int dim_divisor, const char *cls) {
+
+  int tp;
+  make_type(cls, &tp);
+
+  switch(tp) {
+  case SF_Point: {
+    const double* p = coordinates(sfg, keep);
+    parts.push_back({p, p + 1, 1, false});
+    break;
+  }
+  case SF_MultiPoint: {
+    size_t n = Rf_xlength(sfg) / dim_divisor;
+    const double* p = coordinates(sfg, keep);
+    for (size_t i = 0; i < n; i++) {
+      parts.push_back({p + i, p + i + n, 1, false});
+    }
+    break;
+  }
+  case SF_LineString:
+    gather_vector(parts, keep, sfg, dim_divisor);
+    break;
+  case SF_MultiLineString: {
+    R_xlen_t n = Rf_xlength(sfg);
+    for (R_xlen_t i = 0; i < n; i++) {
+      gather_vector(parts, keep, VECTOR_ELT(sfg, i), dim_divisor);
+    }
+    break;
+  }
+  case SF_Polygon:
+    gather_matrix_list(parts, keep, sfg, dim_divisor);
+    break;
+  case SF_MultiPolygon: {
+    R_xlen_t n = Rf_xlength(sfg);
+    for (R_xlen_t i = 0; i < n; i++) {
+      gather_matrix_list(parts, keep, VECTOR_ELT(sfg, i), dim_divisor);
+    }
+    break;
+  }
+  case SF_Geometry: {
+    Rcpp::CharacterVector cls_attr = getSfClass(sfg);
+    gather_data(parts, keep, sfg, dim_divisor, cls_attr[1]);
+    break;
+  }
+  default: {
+    Rcpp::stop("encoding this sf type is currently not supported");
+  }
+  }
+}
+
+// Ends the polylines of a geometry that began at part `first`. MULTI*
+// objects end on a split, which isn't kept; a geometry with no parts of its
+// own must leave the previous geometry's alone.
+inline size_t end_geometry(EncodedPolylines& out, size_t first) {
+  if (out.parts() > first) {
+    out.pop_split();
+  }
+  return out.parts();
+}
+
+// Parallel version of rcpp_encodeSfGeometry(). The class lookups and
+// coordinate pointers are gathered serially, and the encoding runs on
+// `threads` workers. Each worker appends to its own buffers, recording which
+// parts each geometry took, and the character vectors are assembled in
+// order afterwards.
+Rcpp::List encodeSfGeometryParallel(Rcpp::List sfc, bool strip, int precision, int threads,
+                                    bool zm, int z_precision, int m_precision) {
+
+  Rcpp::CharacterVector cls_attr = sfc.attr("class");
+  R_xlen_t n_sfc = sfc.size();
+
+  std::vector< Rcpp::CharacterVector > sfg_dims(n_sfc);
+  std::vector< std::vector< PolylinePart > > parts(n_sfc);
+  std::vector< ZMStream > zm_streams(n_sfc);
+  std::vector< Rcpp::NumericVector > keep;
+  int dim_divisor;
+
+  for (R_xlen_t i = 0; i < n_sfc; i++) {
+    SEXP sfg = sfc[i];
+    sfg_dims[i] = getSfClass(sfg);
+    zm_streams[i] = make_zm_stream(sfg_dims[i][0], z_precision, m_precision);
+
+    if (Rf_xlength(sfg) > 0) {
+      make_dim_divisor(sfg_dims[i][0], &dim_divisor);
+      gather_data(parts[i], keep, sfg, dim_divisor, cls_attr[0]);
+    }
+  }
+
+  std::vector< EncodedPolylines > encoded(threads);
+  std::vector< EncodedPolylines > encoded_zm(zm ? threads : 0);
+  std::vector< EncodedRange > ranges(n_sfc);
+  std::vector< EncodedRange > zm_ranges(zm ? n_sfc : 0);
+  std::vector< char > zm_valid(zm ? n_sfc : 0, 1);
+
+  parallel_for(n_sfc, threads, [&](size_t i, int worker) {
+    EncodedPolylines& out = encoded[worker];
+    EncodedPolylines* out_zm = zm ? &encoded_zm[worker] : NULL;
+    bool with_zm = zm && !zm_streams[i].empty();
+
+    ranges[i].worker = worker;
+    ranges[i].first = out.parts();
+    if (zm) {
+      zm_ranges[i].worker = worker;
+      zm_ranges[i].first = out_zm->parts();
+    }
+
+    for (const PolylinePart& part : parts[i]) {
+      if (part.split) {
+        out.split();
+        if (with_zm) {
+          out_zm->split();
+        }
+        continue;
+      }
+      add_polyline(out, precision, part.lon, part.lat, part.n);
+      if (with_zm && !add_zm_polyline(*out_zm, zm_streams[i], part.lon, part.lat, part.n)) {
+        zm_valid[i] = 0;
+      }
+    }
+
+    ranges[i].last = end_geometry(out, ranges[i].first);
+    if (zm) {
+      zm_ranges[i].last = end_geometry(*out_zm, zm_ranges[i].first);
+    }
+  });
+
+  Rcpp::List output(n_sfc);
+  for (R_xlen_t i = 0; i < n_sfc; i++) {
+    if (zm && !zm_valid[i]) {
+      Rcpp::stop("Z and M values must be finite or NA");
+    }
+    const EncodedRange& r = ranges[i];
+    Rcpp::CharacterVector sv = polyline_strings( encoded[r.worker], r.first, r.last );
+    if(strip == FALSE) {
+      sv.attr("sfc") = sfg_dims[i];
+    }
+    output[i] = sv;
+  }
+
+  if (zm) {
+    Rcpp::List output_zm(n_sfc);
+    for (R_xlen_t i = 0; i < n_sfc; i++) {
+      const EncodedRange& r = zm_ranges[i];
+      Rcpp::CharacterVector zmsv = polyline_strings( encoded_zm[r.worker], r.first, r.last );
+      zmsv.attr("zm") = Rcpp::CharacterVector::create( sfg_dims[i][0] );
+      output_zm[i] = zmsv;
+    }
+    return Rcpp::List::create(
+      _["XY"] = output,
+      _["ZM"] = output_zm
+    );
+  }
+  return output;
+}
+
+// @param zm also encode the Z and M of XYZ, XYM and XYZM geometries, in the
+// same pass, returning list(XY = , ZM = )
+// @param z_precision, m_precision the decimal places Z and M are encoded to
 // [[Rcpp::export]]
-Rcpp::List rcpp_encodeSfGeometry(Rcpp::List sfc, bool strip){
+Rcpp::List rcpp_encodeSfGeometry(Rcpp::List sfc, bool strip, int precision, int threads,
+                                 bool zm, int z_precision, int m_precision){
   
+  if (threads > 1) {
+    return encodeSfGeometryParallel(sfc, strip, precision, threads, zm, z_precision, m_precision);
+  }
+  
+
   Rcpp::CharacterVector cls_attr = sfc.attr("class");
 
   Rcpp::CharacterVector sfg_dim;
   int dim_divisor;
   
   Rcpp::List output(sfc.size());
-  //Rcpp::List output_zm(sfc.size());
-  int lastItem;
-  Rcpp::List thisSfc;
-  std::string str;
+  Rcpp::List output_zm(zm ? sfc.size() : 0);
   Rcpp::CharacterVector sv;
-  
-  // TODO(empty geometries should not enter this list and return something?)
+  PolylineEncoder enc(precision);
+  enc.zm = zm;
   
   for (int i = 0; i < sfc.size(); i++){
 
-    std::ostringstream os;
-    std::ostringstream oszm;
+    enc.polylines.clear();
+    enc.zm_polylines.clear();
     Rcpp::checkUserInterrupt();
 
     sfg_dim = getSfClass(sfc[i]);
-    thisSfc = sfc[i];
+    enc.zm_stream = make_zm_stream(sfg_dim[0], z_precision, m_precision);
     
-    if (thisSfc.size() > 0 ) {
+    if (Rf_xlength(sfc[i]) > 0 ) {
       
       make_dim_divisor(sfg_dim[0], &dim_divisor);
       
-      write_data(os, oszm, sfg_dim, dim_divisor, sfc[i], cls_attr[0], 0);
+      write_data(enc, sfg_dim, dim_divisor, sfc[i], cls_attr[0], 0);
     }
 
-    str = os.str();
-    // std::string zmstr = oszm.str();
-
-    split(str, ' ');
-    // std::vector< std::string > zmstrs = split(zmstr, ' ');
-
-    
     // MULTI* objects
-    lastItem = global_vars::elems.size() - 1;
-    
-    if (lastItem >= 0) {
-
-      if (global_vars::elems[lastItem] == "-") {
-        global_vars::elems.erase(global_vars::elems.end() - 1);
-        // if (dim_divisor > 2 ) {
-        //   zmstrs.erase(zmstrs.end() - 1);
-        // }
-      }
-    }
+    enc.polylines.pop_split();
 
-    sv = wrap( global_vars::elems );
-    // Rcpp::CharacterVector zmsv = wrap( zmstrs );
+    sv = polyline_strings( enc.polylines );
 
     if(strip == FALSE) {
       sv.attr("sfc") = sfg_dim;
-      // zmsv.attr("zm") = as< Rcpp::CharacterVector >( sfg_dim[0] );
     }
     output[i] = sv;
-    // output_zm[i] = zmsv;
+
+    if (zm) {
+      enc.zm_polylines.pop_split();
+      Rcpp::CharacterVector zmsv = polyline_strings( enc.zm_polylines );
+      zmsv.attr("zm") = Rcpp::CharacterVector::create( sfg_dim[0] );
+      output_zm[i] = zmsv;
+    }
   }
   
-  // TODO(only return zm stream IFF there are dim attributes?)
-  // return Rcpp::List::create(
-  //   _["XY"] = output
-  //   _["ZM"] = output_zm
-  // );
+  if (zm) {
+    return Rcpp::List::create(
+      _["XY"] = output,
+      _["ZM"] = output_zm
+    );
+  }
   return output;
 }
+
+// Gathers the polylines of an sfc and encodes them in `threads` runs
+void encode_columnar(Rcpp::List sfc, int precision, int threads, ColumnarRuns& out) {
+
+  Rcpp::CharacterVector cls_attr = sfc.attr("class");
+  R_xlen_t n_sfc = sfc.size();
+
+  std::vector< PolylinePart > polylines;
+  std::vector< PolylinePart > parts;
+  std::vector< Rcpp::NumericVector > keep;
+  int dim_divisor;
+  int tp;
+
+  out.types.resize(n_sfc);
+  out.geom_offsets.assign(1, 0);
+  out.part_offsets.assign(1, 0);
+
+  for (R_xlen_t i = 0; i < n_sfc; i++) {
+    SEXP sfg = sfc[i];
+    Rcpp::CharacterVector sfg_cls = getSfClass(sfg);
+    make_type(sfg_cls[1], &tp);
+    out.types[i] = tp;
+
+    parts.clear();
+    if (Rf_xlength(sfg) > 0) {
+      make_dim_divisor(sfg_cls[0], &dim_divisor);
+      gather_data(parts, keep, sfg, dim_divisor, cls_attr[0]);
+    }
+
+    // polygons end on a split; the polylines of anything else make one part
+    for (const PolylinePart& part : parts) {
+      if (part.split) {
+        out.part_offsets.push_back(polylines.size());
+      } else {
+        polylines.push_back(part);
+      }
+    }
+    if (polylines.size() > out.part_offsets.back()) {
+      out.part_offsets.push_back(polylines.size());
+    }
+    out.geom_offsets.push_back(out.part_offsets.size() - 1);
+  }
+
+  size_t n_polylines = polylines.size();
+  size_t runs = std::max< size_t >(1, std::min< size_t >(threads, n_polylines));
+  out.n_polylines = n_polylines;
+  out.runs.assign(runs, EncodedPolylines());
+
+  parallel_for(runs, threads, [&](size_t r, int) {
+    for (size_t k = out.first(r); k < out.first(r + 1); k++) {
+      add_polyline(out.runs[r], precision, polylines[k].lon, polylines[k].lat, polylines[k].n);
+    }
+  }, 1);
+
+  out.run_offsets.assign(runs + 1, 0);
+  for (size_t r = 0; r < runs; r++) {
+    out.run_offsets[r + 1] = out.run_offsets[r] + out.runs[r].size;
+  }
+}
+
+// Encodes an sfc into one contiguous buffer with nested offsets, in the
+// style of GeoArrow:
+//
+// - polyline_offsets: polyline k is bytes [polyline_offsets[k], polyline_offsets[k + 1])
+//   of the buffer
+// - part_offsets: part j is polylines [part_offsets[j], part_offsets[j + 1]).
+//   A part is one polygon of a MULTIPOLYGON, or all the polylines of any
+//   other geometry, so there are no SPLIT_CHAR markers.
+// - geom_offsets: geometry i is parts [geom_offsets[i], geom_offsets[i + 1])
+// - type: the sf type code of each geometry
+//
+// The polylines are cut into one contiguous run per thread. Each run is
+// encoded into its own buffer and copied into place once the sizes of the
+// runs before it are known.
+// [[Rcpp::export]]
+Rcpp::List rcpp_encodeSfGeometryColumnar(Rcpp::List sfc, int precision, int threads) {
+
+  ColumnarRuns columnar;
+  encode_columnar(sfc, precision, threads, columnar);
+
+  if (columnar.size() > INT_MAX || columnar.n_polylines > INT_MAX ||
+      columnar.part_offsets.size() > INT_MAX) {
+    Rcpp::stop("too many polylines for the columnar layout");
+  }
+
+  Rcpp::RawVector buffer = Rcpp::no_init(columnar.size());
+  Rcpp::IntegerVector polyline_offsets = Rcpp::no_init(columnar.n_polylines + 1);
+  columnar.copy((char*)RAW(buffer), INTEGER(polyline_offsets), threads);
+
+  return Rcpp::List::create(
+    _["buffer"] = buffer,
+    _["polyline_offsets"] = polyline_offsets,
+    _["part_offsets"] = Rcpp::IntegerVector(columnar.part_offsets.begin(), columnar.part_offsets.end()),
+    _["geom_offsets"] = Rcpp::IntegerVector(columnar.geom_offsets.begin(), columnar.geom_offsets.end()),
+    _["type"] = Rcpp::IntegerVector(columnar.types.begin(), columnar.types.end())
+  );
+}
@@ -1,27 +1,29 @@
 #include <Rcpp.h>
+
+#include <climits>
+#include <cmath>
+
 #include "googlePolylines.h"
+#include "encoder.h"
+#include "decoder.h"
+#include "threads.h"
 
 using namespace Rcpp;
 
-namespace global_vars {
-  std::vector<double> lons;
-  std::vector<double> lats;
-  std::string encodedString;
-  std::vector<std::string> elems;
-}
-
 // [[Rcpp::export]]
-Rcpp::List rcpp_decode_polyline_list( Rcpp::List encodedList, std::string attribute ) {
+Rcpp::List rcpp_decode_polyline_list( Rcpp::List encodedList, std::string attribute, bool integer, int precision, int threads ) {
 
   // If the DIM is just Z or just M, should the result return a vector, rather than
   // a 2-column data.frame? 
   // probably
   
+  if (threads > 1) {
+    return decode_polyline_list_parallel(encodedList, attribute, integer, precision, threads);
+  }
+  
   size_t n = encodedList.size();
   Rcpp::List output(n);
   Rcpp::CharacterVector sfg_dim;
-  std::vector<double> pointsLat;
-  std::vector<double> pointsLon;
   std::vector<std::string> col_headers;
   
   for (size_t i = 0; i < n; i++) {
@@ -36,17 +38,15 @@ Rcpp::List rcpp_decode_polyline_list( Rcpp::List encodedList, std::string attrib
 
     for (size_t j = 0; j < pn; j++ ) {
       
+      PolylineView view = polyline_view(STRING_ELT(polylines, j));
+      
       // If polylines[j] is NA, assign a data frame of NA values
-      if (Rcpp::StringVector::is_na(polylines[j])) {
-        polyline_output[j] = na_dataframe(col_headers);
+      if (view.na) {
+        polyline_output[j] = na_dataframe(col_headers, integer);
         continue;
       }
       
-      Rcpp::StringVector sv(1);
-      sv[0] = polylines[j];
-      
-      std::string s = Rcpp::as< std::string >(sv);
-      polyline_output[j] = decode_polyline(s, col_headers, pointsLat, pointsLon);
+      polyline_output[j] = decode_polyline(view.encoded, view.len, col_headers, integer, precision);
     }
     output[i] = polyline_output;
   }
@@ -55,27 +55,27 @@ Rcpp::List rcpp_decode_polyline_list( Rcpp::List encodedList, std::string attrib
 }
 
 // [[Rcpp::export]]
-Rcpp::List rcpp_decode_polyline(Rcpp::StringVector encodedStrings, Rcpp::String encoded_type) {
+Rcpp::List rcpp_decode_polyline(Rcpp::StringVector encodedStrings, Rcpp::String encoded_type, bool integer, int precision, int threads) {
+
+  if (threads > 1) {
+    return decode_polyline_parallel(encodedStrings, encoded_type, integer, precision, threads);
+  }
 
   int encodedSize = encodedStrings.size();
   Rcpp::List results(encodedSize);
-  std::vector<double> pointsLat;
-  std::vector<double> pointsLon;
   std::vector<std::string> col_headers = get_col_headers(encoded_type);
   
   for(int i = 0; i < encodedSize; i++){
     
+    PolylineView view = polyline_view(STRING_ELT(encodedStrings, i));
+    
     // If encodedStrings[i] is NA, assign a data frame of NA values
-    if (Rcpp::StringVector::is_na(encodedStrings[i])) {
-      results[i] = na_dataframe(col_headers);
+    if (view.na) {
+      results[i] = na_dataframe(col_headers, integer);
       continue;
     }
     
-    // Rcpp::Rcout << encodedStrings << std::endl;
-    
-    std::string encoded = Rcpp::as< std::string >(encodedStrings[i]);
-    
-    Rcpp::List decoded = decode_polyline(encoded, col_headers, pointsLat, pointsLon);
+    Rcpp::List decoded = decode_polyline(view.encoded, view.len, col_headers, integer, precision);
     
     results[i] = decoded;
   }
@@ -84,47 +84,10 @@ Rcpp::List rcpp_decode_polyline(Rcpp::StringVector encodedStrings, Rcpp::String
 }
 
 
-// @param type the type of decoded object, coordinates or ZM Attribute
-Rcpp::List decode_polyline(std::string encoded, 
-                           std::vector<std::string>& col_headers, 
-                           std::vector<double>& pointsLat, 
-                           std::vector<double>& pointsLon) {
-  
-  int len = encoded.size();
-  int index = 0;
-  float lat = 0;
-  float lng = 0;
-  
-  pointsLat.clear();
-  pointsLon.clear();
-  
-  while (index < len){
-    char b;
-    unsigned int shift = 0;
-    int result = 0;
-    do {
-      b = encoded.at(index++) - 63;
-      result |= (b & 0x1f) << shift;
-      shift += 5;
-    } while (b >= 0x20);
-    float dlat = ((result & 1) ? ~(result >> 1) : (result >> 1));
-    lat += dlat;
-    
-    shift = 0;
-    result = 0;
-    do {
-      b = encoded.at(index++) - 63;
-      result |= (b & 0x1f) << shift;
-      shift += 5;
-    } while (b >= 0x20);
-    float dlng = ((result & 1) ? ~(result >> 1) : (result >> 1));
-    lng += dlng;
-
-    pointsLat.push_back(lat * (float)1e-5);
-    pointsLon.push_back(lng * (float)1e-5);
-  }
-  
-  //TODO(ZM attributes)
+// Wraps decoded lat / lon columns in a data.frame
+template <int RTYPE>
+Rcpp::List polyline_dataframe(Rcpp::Vector<RTYPE>& pointsLat, Rcpp::Vector<RTYPE>& pointsLon,
+                              std::vector<std::string>& col_headers) {
   
   // Create List output that has the necessary attributes to make it a 
   // data.frame object.
@@ -134,11 +97,445 @@ Rcpp::List decode_polyline(std::string encoded,
   );
   
   out.attr("class") = "data.frame";
-  out.attr("row.names") = seq(1, pointsLat.size());
+  out.attr("row.names") = compact_row_names(pointsLat.size());
+  
+  return out;
+}
+
+template <int RTYPE>
+Rcpp::List polyline_dataframe(const char* encoded, size_t len, size_t n,
+                              std::vector<std::string>& col_headers, int precision) {
+  
+  Rcpp::Vector<RTYPE> pointsLat = Rcpp::no_init(n);
+  Rcpp::Vector<RTYPE> pointsLon = Rcpp::no_init(n);
+  
+  decode_polyline_into(encoded, len, pointsLat.begin(), pointsLon.begin(), precision);
+  
+  return polyline_dataframe<RTYPE>(pointsLat, pointsLon, col_headers);
+}
+
+// Decodes a batch of polylines on `threads` workers. Every string is sized
+// in parallel, the data.frames are allocated on the main thread, and the
+// coordinates are then decoded straight into them in parallel.
+// 
+// @param col_headers the column names for each distinct sfg dimension
+// @param header_index which col_headers each polyline uses
+template <int RTYPE>
+Rcpp::List decode_views(std::vector< PolylineView >& views, 
+                        std::vector< std::vector<std::string> >& col_headers,
+                        std::vector< size_t >& header_index,
+                        int precision, int threads) {
+  
+  typedef typename Rcpp::traits::storage_type<RTYPE>::type storage_t;
+  
+  size_t n = views.size();
+  std::vector< size_t > sizes(n, 0);
+  std::vector< char > valid(n, 1);
+  
+  parallel_for(n, threads, [&](size_t i, int) {
+    if (!views[i].na) {
+      valid[i] = polyline_size(views[i].encoded, views[i].len, &sizes[i]);
+    }
+  });
+  
+  Rcpp::List results(n);
+  std::vector< storage_t* > lats(n);
+  std::vector< storage_t* > lons(n);
+  
+  for (size_t i = 0; i < n; i++) {
+    
+    if (!valid[i]) {
+      Rcpp::stop("invalid encoded polyline");
+    }
+    
+    std::vector<std::string>& headers = col_headers[header_index[i]];
+    
+    // If the polyline is NA, assign a data frame of NA values
+    if (views[i].na) {
+      results[i] = na_dataframe(headers, RTYPE == INTSXP);
+      continue;
+    }
+    
+    Rcpp::Vector<RTYPE> pointsLat = Rcpp::no_init(sizes[i]);
+    Rcpp::Vector<RTYPE> pointsLon = Rcpp::no_init(sizes[i]);
+    lats[i] = pointsLat.begin();
+    lons[i] = pointsLon.begin();
+    
+    results[i] = polyline_dataframe<RTYPE>(pointsLat, pointsLon, headers);
+  }
+  
+  parallel_for(n, threads, [&](size_t i, int) {
+    if (!views[i].na) {
+      decode_polyline_into(views[i].encoded, views[i].len, lats[i], lons[i], precision);
+    }
+  });
+  
+  return results;
+}
+
+Rcpp::List decode_views(std::vector< PolylineView >& views, 
+                        std::vector< std::vector<std::string> >& col_headers,
+                        std::vector< size_t >& header_index,
+                        bool integer, int precision, int threads) {
+  if (integer) {
+    return decode_views<INTSXP>(views, col_headers, header_index, precision, threads);
+  }
+  return decode_views<REALSXP>(views, col_headers, header_index, precision, threads);
+}
+
+PolylineView polyline_view(SEXP s) {
+  PolylineView view;
+  view.na = s == NA_STRING;
+  view.encoded = view.na ? NULL : CHAR(s);
+  view.len = view.na ? 0 : LENGTH(s);
+  return view;
+}
+
+// Offsets must start at 0 and never go back or past `max`
+bool valid_offsets(SEXP offsets, R_xlen_t max) {
+  if (TYPEOF(offsets) != INTSXP || Rf_xlength(offsets) < 1) {
+    return false;
+  }
+  const int* o = INTEGER(offsets);
+  R_xlen_t n = Rf_xlength(offsets);
+  if (o[0] != 0) {
+    return false;
+  }
+  for (R_xlen_t i = 1; i < n; i++) {
+    if (o[i] == NA_INTEGER || o[i] < o[i - 1]) {
+      return false;
+    }
+  }
+  return o[n - 1] <= max;
+}
+
+ColumnarPolylines columnar_polylines(Rcpp::List columnar) {
+
+  SEXP buffer = columnar["buffer"];
+  SEXP polyline_offsets = columnar["polyline_offsets"];
+  SEXP part_offsets = columnar["part_offsets"];
+  SEXP geom_offsets = columnar["geom_offsets"];
+  SEXP types = columnar["type"];
+
+  if (TYPEOF(buffer) != RAWSXP || TYPEOF(types) != INTSXP ||
+      !valid_offsets(polyline_offsets, Rf_xlength(buffer)) ||
+      !valid_offsets(part_offsets, Rf_xlength(polyline_offsets) - 1) ||
+      !valid_offsets(geom_offsets, Rf_xlength(part_offsets) - 1) ||
+      Rf_xlength(geom_offsets) != Rf_xlength(types) + 1) {
+    Rcpp::stop("invalid encoded_columnar object");
+  }
 
+  ColumnarPolylines out;
+  out.buffer = (const char*)RAW(buffer);
+  out.polyline_offsets = INTEGER(polyline_offsets);
+  out.part_offsets = INTEGER(part_offsets);
+  out.geom_offsets = INTEGER(geom_offsets);
+  out.types = INTEGER(types);
+  out.n = Rf_xlength(types);
   return out;
 }
 
+// Appends the polylines of geometry `feature` (1-based) to `views`. With
+// `splits`, the polygons of a MULTIPOLYGON are separated by SPLIT_CHAR as
+// they are in an encoded_column. Returns its sf type, or SF_Unknown for an
+// NA feature, which has no polylines.
+int columnar_views(const ColumnarPolylines& columnar, int feature,
+                   std::vector< PolylineView >& views, bool splits) {
+
+  static const PolylineView split = {SPLIT_CHAR, 1, false};
+
+  if (feature == NA_INTEGER) {
+    return SF_Unknown;
+  }
+  if (feature < 1 || feature > columnar.n) {
+    Rcpp::stop("invalid encoded_columnar object");
+  }
+
+  int from = columnar.geom_offsets[feature - 1];
+  int to = columnar.geom_offsets[feature];
+
+  for (int part = from; part < to; part++) {
+    if (splits && part > from) {
+      views.push_back(split);
+    }
+    for (int k = columnar.part_offsets[part]; k < columnar.part_offsets[part + 1]; k++) {
+      PolylineView view;
+      view.encoded = columnar.buffer + columnar.polyline_offsets[k];
+      view.len = columnar.polyline_offsets[k + 1] - columnar.polyline_offsets[k];
+      view.na = false;
+      views.push_back(view);
+    }
+  }
+  return columnar.types[feature - 1];
+}
+
+// Decodes the polylines of n features, feature i being views
+// [offsets[i], offsets[i + 1]), into a list of data.frames for each
+Rcpp::List decode_grouped_views(std::vector< PolylineView >& views, std::vector< size_t >& offsets,
+                                bool integer, int precision, int threads) {
+
+  size_t n = offsets.size() - 1;
+  std::vector< std::vector<std::string> > col_headers(1, get_col_headers("XY"));
+  std::vector< size_t > header_index(views.size(), 0);
+  Rcpp::List decoded = decode_views(views, col_headers, header_index, integer, precision, threads);
+
+  Rcpp::List output(n);
+  for (size_t i = 0; i < n; i++) {
+    Rcpp::List polyline_output(offsets[i + 1] - offsets[i]);
+    for (size_t k = offsets[i]; k < offsets[i + 1]; k++) {
+      polyline_output[k - offsets[i]] = decoded[k];
+    }
+    output[i] = polyline_output;
+  }
+  return output;
+}
+
+// Decodes the geometries of an encoded_columnar into a list of data.frames
+// for each, one per polyline, as decode() does for an encoded_column
+// [[Rcpp::export]]
+Rcpp::List rcpp_decode_columnar(Rcpp::IntegerVector features, Rcpp::List columnar,
+                                bool integer, int precision, int threads) {
+
+  ColumnarPolylines cp = columnar_polylines(columnar);
+  R_xlen_t n = features.size();
+  std::vector< PolylineView > views;
+  std::vector< size_t > offsets(n + 1, 0);
+
+  for (R_xlen_t i = 0; i < n; i++) {
+    columnar_views(cp, features[i], views, false);
+    offsets[i + 1] = views.size();
+  }
+
+  return decode_grouped_views(views, offsets, integer, precision, threads);
+}
+
+Rcpp::List decode_polyline_list_parallel(Rcpp::List encodedList, std::string attribute, 
+                                         bool integer, int precision, int threads) {
+  
+  size_t n = encodedList.size();
+  std::vector< PolylineView > views;
+  std::vector< std::vector<std::string> > col_headers(n);
+  std::vector< size_t > header_index;
+  std::vector< size_t > sizes(n);
+  
+  for (size_t i = 0; i < n; i++) {
+    
+    Rcpp::StringVector polylines = encodedList[i];
+    Rcpp::CharacterVector sfg_dim = polylines.attr( attribute );
+    col_headers[i] = get_col_headers(sfg_dim[0]);
+    
+    sizes[i] = polylines.size();
+    for (size_t j = 0; j < sizes[i]; j++) {
+      views.push_back(polyline_view(STRING_ELT(polylines, j)));
+      header_index.push_back(i);
+    }
+  }
+  
+  Rcpp::List decoded = decode_views(views, col_headers, header_index, integer, precision, threads);
+  
+  Rcpp::List output(n);
+  size_t k = 0;
+  for (size_t i = 0; i < n; i++) {
+    Rcpp::List polyline_output(sizes[i]);
+    for (size_t j = 0; j < sizes[i]; j++) {
+      polyline_output[j] = decoded[k++];
+    }
+    output[i] = polyline_output;
+  }
+  return output;
+}
+
+Rcpp::List decode_polyline_parallel(Rcpp::StringVector encodedStrings, Rcpp::String encoded_type,
+                                    bool integer, int precision, int threads) {
+  
+  size_t n = encodedStrings.size();
+  std::vector< PolylineView > views(n);
+  std::vector< std::vector<std::string> > col_headers(1, get_col_headers(encoded_type));
+  std::vector< size_t > header_index(n, 0);
+  
+  for (size_t i = 0; i < n; i++) {
+    views[i] = polyline_view(STRING_ELT(encodedStrings, i));
+  }
+  
+  return decode_views(views, col_headers, header_index, integer, precision, threads);
+}
+
+// Decodes every polyline into one long data.frame of id, part_id, lat, lon.
+// The rows of all polylines are counted first, so each column is allocated
+// once and the coordinates are decoded straight into their slice of it.
+template <int RTYPE>
+Rcpp::List decode_views_flat(std::vector< PolylineView >& views,
+                             std::vector< int >& ids,
+                             std::vector< int >& part_ids,
+                             int precision, int threads) {
+  
+  typedef typename Rcpp::traits::storage_type<RTYPE>::type storage_t;
+  
+  size_t n = views.size();
+  std::vector< size_t > sizes(n, 1);
+  std::vector< char > valid(n, 1);
+  
+  parallel_for(n, threads, [&](size_t i, int) {
+    if (!views[i].na) {
+      valid[i] = polyline_size(views[i].encoded, views[i].len, &sizes[i]);
+    }
+  });
+  
+  // offsets[i] is the first row of polyline i
+  std::vector< size_t > offsets(n + 1, 0);
+  for (size_t i = 0; i < n; i++) {
+    if (!valid[i]) {
+      Rcpp::stop("invalid encoded polyline");
+    }
+    offsets[i + 1] = offsets[i] + sizes[i];
+  }
+  
+  size_t total = offsets[n];
+  Rcpp::IntegerVector id = Rcpp::no_init(total);
+  Rcpp::IntegerVector part_id = Rcpp::no_init(total);
+  Rcpp::Vector<RTYPE> pointsLat = Rcpp::no_init(total);
+  Rcpp::Vector<RTYPE> pointsLon = Rcpp::no_init(total);
+  
+  int* id_ptr = id.begin();
+  int* part_ptr = part_id.begin();
+  storage_t* lat_ptr = pointsLat.begin();
+  storage_t* lon_ptr = pointsLon.begin();
+  storage_t na = Rcpp::traits::get_na<RTYPE>();
+  
+  parallel_for(n, threads, [&](size_t i, int) {
+    size_t from = offsets[i];
+    size_t to = offsets[i + 1];
+    std::fill(id_ptr + from, id_ptr + to, ids[i]);
+    std::fill(part_ptr + from, part_ptr + to, part_ids[i]);
+    
+    // If the polyline is NA, it gets a single row of NA values
+    if (views[i].na) {
+      lat_ptr[from] = na;
+      lon_ptr[from] = na;
+      return;
+    }
+    decode_polyline_into(views[i].encoded, views[i].len, lat_ptr + from, lon_ptr + from, precision);
+  });
+  
+  Rcpp::List out = Rcpp::List::create(
+    Named("id") = id,
+    Named("part_id") = part_id,
+    Named("lat") = pointsLat,
+    Named("lon") = pointsLon
+  );
+  
+  out.attr("class") = "data.frame";
+  out.attr("row.names") = compact_row_names(total);
+  
+  return out;
+}
+
+Rcpp::List decode_views_flat(std::vector< PolylineView >& views,
+                             std::vector< int >& ids,
+                             std::vector< int >& part_ids,
+                             bool integer, int precision, int threads) {
+  if (integer) {
+    return decode_views_flat<INTSXP>(views, ids, part_ids, precision, threads);
+  }
+  return decode_views_flat<REALSXP>(views, ids, part_ids, precision, threads);
+}
+
+// @param encoded either a character vector, where each polyline is its own id,
+// or an encoded_column, where each element is an id and its polylines are the
+// parts. The SPLIT_CHAR markers between polygons are not parts.
+// [[Rcpp::export]]
+Rcpp::List rcpp_decode_polyline_flat(SEXP encoded, bool integer, int precision, int threads) {
+  
+  std::vector< PolylineView > views;
+  std::vector< int > ids;
+  std::vector< int > part_ids;
+  
+  R_xlen_t n = Rf_xlength(encoded);
+  
+  if (TYPEOF(encoded) == STRSXP) {
+    for (R_xlen_t i = 0; i < n; i++) {
+      views.push_back(polyline_view(STRING_ELT(encoded, i)));
+      ids.push_back(i + 1);
+      part_ids.push_back(1);
+    }
+  } else if (TYPEOF(encoded) == VECSXP) {
+    for (R_xlen_t i = 0; i < n; i++) {
+      SEXP polylines = VECTOR_ELT(encoded, i);
+      if (TYPEOF(polylines) != STRSXP) {
+        Rcpp::stop("encoded polylines must be character vectors");
+      }
+      int part = 0;
+      R_xlen_t pn = Rf_xlength(polylines);
+      for (R_xlen_t j = 0; j < pn; j++) {
+        PolylineView view = polyline_view(STRING_ELT(polylines, j));
+        if (is_split(view)) {
+          continue;
+        }
+        views.push_back(view);
+        ids.push_back(i + 1);
+        part_ids.push_back(++part);
+      }
+    }
+  } else {
+    Rcpp::stop("I don't know how to decode this object");
+  }
+  
+  return decode_views_flat(views, ids, part_ids, integer, precision, threads);
+}
+
+// The flat decode() of an encoded_columnar, with each geometry an id and its
+// polylines the parts
+// [[Rcpp::export]]
+Rcpp::List rcpp_decode_columnar_flat(Rcpp::IntegerVector features, Rcpp::List columnar,
+                                     bool integer, int precision, int threads) {
+
+  ColumnarPolylines cp = columnar_polylines(columnar);
+  R_xlen_t n = features.size();
+  std::vector< PolylineView > views;
+  std::vector< int > ids;
+  std::vector< int > part_ids;
+
+  for (R_xlen_t i = 0; i < n; i++) {
+    size_t from = views.size();
+    columnar_views(cp, features[i], views, false);
+    for (size_t k = from; k < views.size(); k++) {
+      ids.push_back(i + 1);
+      part_ids.push_back(k - from + 1);
+    }
+  }
+
+  return decode_views_flat(views, ids, part_ids, integer, precision, threads);
+}
+
+// @param encoded, len the polyline's bytes, read in place from its CHARSXP
+// @param type the type of decoded object, coordinates or ZM Attribute
+// @param integer return the coordinates as integer 10^-precision degrees
+// @param precision the number of decimal places the coordinates were encoded to
+Rcpp::List decode_polyline(const char* encoded, size_t len,
+                           std::vector<std::string>& col_headers,
+                           bool integer, int precision) {
+  
+  size_t n;
+  
+  // size the output first so the coordinates are decoded straight into it
+  if (!polyline_size(encoded, len, &n)) {
+    Rcpp::stop("invalid encoded polyline");
+  }
+  
+  if (integer) {
+    return polyline_dataframe<INTSXP>(encoded, len, n, col_headers, precision);
+  }
+  return polyline_dataframe<REALSXP>(encoded, len, n, col_headers, precision);
+}
+
+// The compact c(NA, -n) form R uses for automatic row names
+Rcpp::IntegerVector compact_row_names(R_xlen_t n) {
+  if (n == 0) {
+    return Rcpp::IntegerVector(0);
+  }
+  return Rcpp::IntegerVector::create(NA_INTEGER, -(int)n);
+}
+
 std::vector<std::string> get_col_headers(Rcpp::String sfg_dim) {
   std::vector<std::string> out;
   if (sfg_dim == "XYZ" || sfg_dim == "XYZM") {
@@ -155,13 +552,21 @@ std::vector<std::string> get_col_headers(Rcpp::String sfg_dim) {
   return out;
 }
 
-Rcpp::List na_dataframe(std::vector<std::string>& col_headers) {
+Rcpp::List na_dataframe(std::vector<std::string>& col_headers, bool integer) {
   // Create List output that has the necessary attributes to make it a 
   // data.frame object.
-  Rcpp::List out = Rcpp::List::create(
-    Named(col_headers[0]) = NA_REAL, 
-    Named(col_headers[1]) = NA_REAL
-  );
+  Rcpp::List out;
+  if (integer) {
+    out = Rcpp::List::create(
+      Named(col_headers[0]) = NA_INTEGER, 
+      Named(col_headers[1]) = NA_INTEGER
+    );
+  } else {
+    out = Rcpp::List::create(
+      Named(col_headers[0]) = NA_REAL, 
+      Named(col_headers[1]) = NA_REAL
+    );
+  }
   
   out.attr("class") = "data.frame";
   out.attr("row.names") = 1;
@@ -169,81 +574,606 @@ Rcpp::List na_dataframe(std::vector<std::string>& col_headers) {
   return out;
 }
 
-void EncodeNumber(std::ostringstream& os, int num){
+template <int P>
+std::string encode_polyline(PolylineEncoder& enc, const double* lons, const double* lats, size_t n){
   
-  std::string out_str;
+  enc.buffer.resize(max_encoded_size<P>(n));
+  char* end = write_polyline<P>(enc.buffer.data(), lons, lats, n);
   
-  while(num >= 0x20){
-    out_str += (char)(0x20 | (int)(num & 0x1f)) + 63;
-    num >>= 5;
+  return std::string(enc.buffer.data(), end);
+}
+
+std::string encode_polyline(PolylineEncoder& enc, const double* lons, const double* lats, size_t n){
+  switch (enc.precision) {
+  case 6:
+    return encode_polyline<6>(enc, lons, lats, n);
+  case 7:
+    return encode_polyline<7>(enc, lons, lats, n);
+  default:
+    return encode_polyline<5>(enc, lons, lats, n);
   }
-  
-  out_str += char(num + 63);
-  os << out_str;
 }
 
-void EncodeSignedNumber(std::ostringstream& os, int num){
-  
-  unsigned int ui = num;      //3
-  ui <<= 1;                   //4
-  ui = (num < 0) ? ~ui : ui;  //5
-  EncodeNumber(os, ui);
+template <int P>
+void add_polyline(EncodedPolylines& out, const double* lons, const double* lats, size_t n) {
+  out.wrote(write_polyline<P>(out.reserve(max_encoded_size<P>(n)), lons, lats, n));
+  out.end_part();
 }
 
-std::string encode_polyline(){
-  
-  int plat = 0;
-  int plon = 0;
-  int late5;
-  int lone5;
-  
-  std::ostringstream os;
+// Encodes n coordinates straight onto the end of `out`
+void add_polyline(EncodedPolylines& out, int precision, const double* lons, const double* lats, size_t n) {
+  switch (precision) {
+  case 6:
+    add_polyline<6>(out, lons, lats, n);
+    break;
+  case 7:
+    add_polyline<7>(out, lons, lats, n);
+    break;
+  default:
+    add_polyline<5>(out, lons, lats, n);
+  }
+}
 
-  for(unsigned int i = 0; i < global_vars::lats.size(); i++){
-    
-    late5 = global_vars::lats[i] * 1e5;
-    lone5 = global_vars::lons[i] * 1e5;
-    
-    EncodeSignedNumber(os, late5 - plat);
-    EncodeSignedNumber(os, lone5 - plon);
+// The ZM stream of a geometry of dimension `dim`. The Z and M precisions are
+// decimal places, from 0 to 7.
+ZMStream make_zm_stream(const char* dim, int z_precision, int m_precision) {
+  ZMStream zm;
+  zm.z_col = 0;
+  zm.m_col = 0;
+  if (strcmp(dim, "XYZ") == 0) {
+    zm.z_col = 2;
+  } else if (strcmp(dim, "XYM") == 0) {
+    zm.m_col = 2;
+  } else if (strcmp(dim, "XYZM") == 0) {
+    zm.z_col = 2;
+    zm.m_col = 3;
+  }
+  zm.z_scale = std::pow(10.0, z_precision);
+  zm.m_scale = std::pow(10.0, m_precision);
+  return zm;
+}
+
+// Encodes the Z and M of n points onto the end of `out`. The points are rows
+// of a column-major matrix whose X and Y columns start at lons and lats, so
+// the Z and M columns follow at the same stride. Returns false, writing
+// nothing, if a Z or M is infinite or too large to encode.
+bool add_zm_polyline(EncodedPolylines& out, const ZMStream& zm, const double* lons, const double* lats, size_t n) {
+  ptrdiff_t stride = lats - lons;
+  const double* z = zm.z_col == 0 ? NULL : lons + zm.z_col * stride;
+  const double* m = zm.m_col == 0 ? NULL : lons + zm.m_col * stride;
+  char* end = write_zm_polyline(out.reserve(max_zm_encoded_size(n)), z, m, n, zm.z_scale, zm.m_scale);
+  if (end == NULL) {
+    return false;
+  }
+  out.wrote(end);
+  out.end_part();
+  return true;
+}
+
+// Decodes a ZM column, the Z and M polylines of each geometry, into a list
+// of Z / M data.frames for each. The dimension a geometry doesn't have was
+// encoded as 0, so decodes as 0, and an NA Z or M decodes as NA. An XY
+// geometry has neither, so gets a single row of NA. The split markers between
+// the polygons of a MULTIPOLYGON are skipped.
+// [[Rcpp::export]]
+Rcpp::List rcpp_decode_zm(Rcpp::List zmList, int z_precision, int m_precision, int threads) {
+
+  size_t n_geoms = zmList.size();
+  std::vector< PolylineView > views;
+  std::vector< size_t > offsets(n_geoms + 1, 0);
+  std::vector< ZMStream > streams(n_geoms);
+
+  for (size_t i = 0; i < n_geoms; i++) {
+    Rcpp::StringVector polylines = zmList[i];
+    if (Rf_isNull(polylines.attr("zm"))) {
+      Rcpp::stop("No zm attribute found");
+    }
+    Rcpp::CharacterVector dim = polylines.attr("zm");
+    streams[i] = make_zm_stream(dim[0], z_precision, m_precision);
+    if (streams[i].empty()) {
+      if (strcmp(dim[0], "XY") != 0) {
+        Rcpp::stop("zm attribute must be one of XY, XYZ, XYM or XYZM");
+      }
+      PolylineView none = { NULL, 0, true };
+      views.push_back(none);
+      offsets[i + 1] = views.size();
+      continue;
+    }
+
+    for (R_xlen_t j = 0; j < polylines.size(); j++) {
+      PolylineView view = polyline_view(STRING_ELT(polylines, j));
+      if (!view.na && is_split(view)) {
+        continue;
+      }
+      views.push_back(view);
+    }
+    offsets[i + 1] = views.size();
+  }
+
+  size_t n = views.size();
+  std::vector< size_t > sizes(n, 0);
+  std::vector< char > valid(n, 1);
+
+  parallel_for(n, threads, [&](size_t k, int) {
+    if (!views[k].na) {
+      valid[k] = polyline_size(views[k].encoded, views[k].len, &sizes[k]);
+    }
+  });
 
-    plat = late5;
-    plon = lone5;
+  Rcpp::List output(n_geoms);
+  std::vector< double* > zs(n);
+  std::vector< double* > ms(n);
+  std::vector< size_t > geom(n);
+
+  for (size_t i = 0; i < n_geoms; i++) {
+    Rcpp::List polyline_output(offsets[i + 1] - offsets[i]);
+
+    for (size_t k = offsets[i]; k < offsets[i + 1]; k++) {
+      if (!valid[k]) {
+        Rcpp::stop("invalid encoded polyline");
+      }
+      geom[k] = i;
+
+      // an NA polyline is a single row of NA
+      size_t rows = views[k].na ? 1 : sizes[k];
+      Rcpp::NumericVector z = Rcpp::no_init(rows);
+      Rcpp::NumericVector m = Rcpp::no_init(rows);
+      zs[k] = z.begin();
+      ms[k] = m.begin();
+      if (views[k].na) {
+        z[0] = NA_REAL;
+        m[0] = NA_REAL;
+      }
+
+      Rcpp::List df = Rcpp::List::create(
+        Named("Z") = z,
+        Named("M") = m
+      );
+      df.attr("class") = "data.frame";
+      df.attr("row.names") = compact_row_names(rows);
+      polyline_output[k - offsets[i]] = df;
+    }
+    output[i] = polyline_output;
   }
+
+  parallel_for(n, threads, [&](size_t k, int) {
+    if (views[k].na) {
+      return;
+    }
+    const ZMStream& zm = streams[geom[k]];
+    double* z = zs[k];
+    double* m = ms[k];
+    decode_polyline_scaled<7>(views[k].encoded, views[k].len, [&](size_t j, int64_t im, int64_t iz) {
+      z[j] = iz == ZM_NA ? NA_REAL : iz / zm.z_scale;
+      m[j] = im == ZM_NA ? NA_REAL : im / zm.m_scale;
+    });
+  });
+
+  return output;
+}
+
+// Makes one CHARSXP per polyline, parts [from, to) of `polylines`, straight
+// from the encoded bytes. Polylines are pure ASCII, which Rf_mkCharLenCE()
+// flags on the CHARSXP, so R never has to translate them.
+Rcpp::CharacterVector polyline_strings(const EncodedPolylines& polylines, size_t from, size_t to) {
   
-  return os.str();
+  Rcpp::CharacterVector out(to - from);
+  
+  for (size_t i = from; i < to; i++) {
+    if (polylines.is_split(i)) {
+      SET_STRING_ELT(out, i - from, Rf_mkChar(SPLIT_CHAR));
+      continue;
+    }
+    size_t begin = polylines.begin(i);
+    size_t len = polylines.ends[i] - begin;
+    if (len > 0) {
+      SET_STRING_ELT(out, i - from, Rf_mkCharLenCE(polylines.buffer.data() + begin, len, CE_UTF8));
+    }
+  }
+  return out;
+}
+
+Rcpp::CharacterVector polyline_strings(const EncodedPolylines& polylines) {
+  return polyline_strings(polylines, 0, polylines.parts());
 }
 
 // [[Rcpp::export]]
 std::string rcpp_encode_polyline(
-    std::vector<double> longitude,
-    std::vector<double> latitude
+    Rcpp::NumericVector longitude,
+    Rcpp::NumericVector latitude,
+    int precision
 ) {
-  global_vars::lons = longitude;
-  global_vars::lats = latitude;
-  return encode_polyline();
+  size_t n = std::min(longitude.size(), latitude.size());
+  PolylineEncoder enc(precision);
+  return encode_polyline(enc, REAL(longitude), REAL(latitude), n);
+}
+
+// Encodes every row as a one point polyline. A point's two varints are
+// written into a slot that always has room for them, on the stack when
+// serial or in one block of n slots when the rows are shared between
+// `threads` workers, and its CHARSXP is made straight from the slot.
+template <int P>
+Rcpp::StringVector encode_point_rows(const double* lons, const double* lats, size_t n, int threads) {
+
+  typedef typename PolylinePrecision<P>::coord_type coord_type;
+  const size_t slot = 2 * PolylinePrecision<P>::max_varint_chars;
+
+  Rcpp::StringVector res(n);
+
+  if (threads <= 1) {
+    char buffer[slot];
+    for (size_t i = 0; i < n; i++) {
+      coord_type plat = 0;
+      coord_type plon = 0;
+      char* end = write_coordinate<P>(buffer, lons[i], lats[i], plat, plon);
+      SET_STRING_ELT(res, i, Rf_mkCharLenCE(buffer, end - buffer, CE_UTF8));
+    }
+    return res;
+  }
+
+  std::vector< char > buffer(n * slot);
+  std::vector< unsigned char > lens(n);
+
+  parallel_for(n, threads, [&](size_t i, int) {
+    coord_type plat = 0;
+    coord_type plon = 0;
+    char* out = buffer.data() + i * slot;
+    lens[i] = write_coordinate<P>(out, lons[i], lats[i], plat, plon) - out;
+  }, 4096);
+
+  for (size_t i = 0; i < n; i++) {
+    SET_STRING_ELT(res, i, Rf_mkCharLenCE(buffer.data() + i * slot, lens[i], CE_UTF8));
+  }
+  return res;
 }
 
 // [[Rcpp::export]]
-std::vector<std::string> rcpp_encode_polyline_byrow(
+Rcpp::StringVector rcpp_encode_polyline_byrow(
     Rcpp::NumericVector longitude,
-    Rcpp::NumericVector latitude
+    Rcpp::NumericVector latitude,
+    int precision,
+    int threads
   ) { 
   
   size_t n = longitude.length();
-  std::vector<std::string> res;
-  global_vars::lons.clear();
-  global_vars::lons.resize(1);
-  global_vars::lats.clear();
-  global_vars::lats.resize(1);
-  
-  for ( size_t i = 0; i < n; i++ ) {
+  if ((size_t)latitude.length() < n) {
+    Rcpp::stop("longitude and latitude must be the same length");
+  }
 
-    global_vars::lons[0] = longitude[i];
-    global_vars::lats[0] = latitude[i];
+  switch (precision) {
+  case 6:
+    return encode_point_rows<6>(REAL(longitude), REAL(latitude), n, threads);
+  case 7:
+    return encode_point_rows<7>(REAL(longitude), REAL(latitude), n, threads);
+  default:
+    return encode_point_rows<5>(REAL(longitude), REAL(latitude), n, threads);
+  }
+}
 
-    res.push_back(encode_polyline());
+
+// Encodes one polyline per group in a single pass. Group g (1-based, as
+// match() numbers them) is the rows whose `group` is g, in the order they
+// appear. Rows already in runs of their group are encoded in place;
+// otherwise they are first gathered into group order by a stable counting
+// pass. The groups are shared between `threads` workers, each writing into
+// its own buffer, and the strings are made in order afterwards.
+// [[Rcpp::export]]
+Rcpp::StringVector rcpp_encode_polyline_grouped(
+    Rcpp::NumericVector longitude,
+    Rcpp::NumericVector latitude,
+    Rcpp::IntegerVector group,
+    int n_groups,
+    int precision,
+    int threads
+  ) {
+
+  size_t n = std::min(std::min(longitude.size(), latitude.size()), group.size());
+  const int* g = INTEGER(group);
+
+  std::vector< size_t > offsets(n_groups + 1, 0);
+  bool runs = true;
+  for (size_t i = 0; i < n; i++) {
+    if (g[i] == NA_INTEGER || g[i] < 1 || g[i] > n_groups) {
+      Rcpp::stop("invalid group");
+    }
+    offsets[g[i]]++;
+    runs = runs && (i == 0 || g[i] >= g[i - 1]);
+  }
+  for (int k = 0; k < n_groups; k++) {
+    offsets[k + 1] += offsets[k];
+  }
+
+  const double* lons = REAL(longitude);
+  const double* lats = REAL(latitude);
+  std::vector< double > grouped_lons;
+  std::vector< double > grouped_lats;
+
+  if (!runs) {
+    grouped_lons.resize(n);
+    grouped_lats.resize(n);
+    std::vector< size_t > next(offsets.begin(), offsets.end() - 1);
+    for (size_t i = 0; i < n; i++) {
+      size_t to = next[g[i] - 1]++;
+      grouped_lons[to] = lons[i];
+      grouped_lats[to] = lats[i];
+    }
+    lons = grouped_lons.data();
+    lats = grouped_lats.data();
+  }
+
+  std::vector< EncodedPolylines > encoded(std::max(threads, 1));
+  std::vector< int > owner(n_groups);
+  std::vector< size_t > part(n_groups);
+
+  parallel_for(n_groups, threads, [&](size_t k, int worker) {
+    EncodedPolylines& out = encoded[worker];
+    owner[k] = worker;
+    part[k] = out.parts();
+    add_polyline(out, precision, lons + offsets[k], lats + offsets[k], offsets[k + 1] - offsets[k]);
+  });
+
+  Rcpp::StringVector res(n_groups);
+  for (int k = 0; k < n_groups; k++) {
+    const EncodedPolylines& out = encoded[owner[k]];
+    size_t from = out.begin(part[k]);
+    SET_STRING_ELT(res, k, Rf_mkCharLenCE(out.buffer.data() + from, out.ends[part[k]] - from, CE_UTF8));
   }
   return res;
 }
 
+// Builds the checkpoint index of a vector of polylines: before every
+// `every`th point of each, the byte offset it starts at and the absolute
+// lat / lon (in 10^-P degrees) the point is a delta from. The rows of the
+// integer matrix are (polyline, offset, lat, lon), in polyline order. The
+// byte length of each polyline is kept as its "lengths" attribute, so a
+// polyline replaced since can be told from the one indexed.
+template <int P>
+Rcpp::IntegerMatrix polyline_index(std::vector< PolylineView >& views, size_t every, int threads) {
+
+  size_t n = views.size();
+  std::vector< std::vector< int > > checkpoints(n);
+  std::vector< char > valid(n, 1);
+  std::vector< char > in_range(n, 1);
+
+  parallel_for(n, threads, [&](size_t i, int) {
+    size_t n_points;
+    if (views[i].na) {
+      return;
+    }
+    if (!polyline_size(views[i].encoded, views[i].len, &n_points)) {
+      valid[i] = 0;
+      return;
+    }
+    std::vector< int >& out = checkpoints[i];
+    out.reserve((n_points / every) * 3);
+    polyline_checkpoints<P>(views[i].encoded, views[i].len, every,
+                            [&](size_t offset, int64_t lat, int64_t lon) {
+      in_range[i] &= lat >= INT_MIN && lat <= INT_MAX && lon >= INT_MIN && lon <= INT_MAX;
+      out.push_back((int)offset);
+      out.push_back((int)lat);
+      out.push_back((int)lon);
+    });
+  });
+
+  size_t rows = 0;
+  for (size_t i = 0; i < n; i++) {
+    if (!valid[i]) {
+      Rcpp::stop("invalid encoded polyline");
+    }
+    if (!in_range[i]) {
+      Rcpp::stop("the coordinates of polyline %i are too large to index", (int)(i + 1));
+    }
+    rows += checkpoints[i].size() / 3;
+  }
+
+  Rcpp::IntegerMatrix index(rows, 4);
+  size_t row = 0;
+  for (size_t i = 0; i < n; i++) {
+    const std::vector< int >& c = checkpoints[i];
+    for (size_t k = 0; k < c.size(); k += 3, row++) {
+      index(row, 0) = i + 1;
+      index(row, 1) = c[k];
+      index(row, 2) = c[k + 1];
+      index(row, 3) = c[k + 2];
+    }
+  }
+  Rcpp::colnames(index) = Rcpp::CharacterVector::create("polyline", "offset", "lat", "lon");
+
+  Rcpp::IntegerVector lengths(n);
+  for (size_t i = 0; i < n; i++) {
+    lengths[i] = views[i].na ? NA_INTEGER : (int)views[i].len;
+  }
+  index.attr("lengths") = lengths;
+  return index;
+}
+
+// [[Rcpp::export]]
+Rcpp::IntegerMatrix rcpp_polyline_index(Rcpp::StringVector polylines, int every, int precision, int threads) {
+
+  std::vector< PolylineView > views(polylines.size());
+  for (R_xlen_t i = 0; i < polylines.size(); i++) {
+    views[i] = polyline_view(STRING_ELT(polylines, i));
+  }
+
+  switch (precision) {
+  case 6:
+    return polyline_index<6>(views, every, threads);
+  case 7:
+    return polyline_index<7>(views, every, threads);
+  default:
+    return polyline_index<5>(views, every, threads);
+  }
+}
+
+// Where to start and stop decoding points [from, to) (0-based) of one
+// polyline, found from its checkpoints
+struct PolylineSlice {
+  size_t begin;        // byte offsets of the part to decode
+  size_t end;
+  size_t base;         // the point it starts with
+  int lat;             // the running sums it starts from
+  int lon;
+  size_t from;         // the points kept
+  size_t to;
+  bool valid;
+};
+
+// Decodes points `from` to `to` (1-based, inclusive) of each polyline. With
+// an index from rcpp_polyline_index(), each polyline is decoded from the
+// last checkpoint at or before `from` up to the first checkpoint after `to`,
+// so at most `every` points either side are decoded and not kept. Without
+// one, each is decoded from its start. A polyline whose length isn't the one
+// indexed, or whose checkpoints don't fall between its values, is an error
+// rather than a seek into the wrong bytes.
+template <int P>
+Rcpp::List polyline_slice(std::vector< PolylineView >& views, SEXP index, size_t every,
+                          const int* from, const int* to, int threads) {
+
+  size_t n = views.size();
+  std::vector< size_t > starts(n + 1, 0);
+  const int* rows = NULL;
+  const int* lengths = NULL;
+  size_t n_rows = 0;
+
+  if (!Rf_isNull(index)) {
+    SEXP indexed = Rf_getAttrib(index, Rf_install("lengths"));
+    if (TYPEOF(index) != INTSXP || !Rf_isMatrix(index) || Rf_ncols(index) != 4 ||
+        TYPEOF(indexed) != INTSXP || (size_t)Rf_xlength(indexed) != n) {
+      Rcpp::stop("invalid polyline_index");
+    }
+    lengths = INTEGER(indexed);
+    rows = INTEGER(index);
+    n_rows = Rf_nrows(index);
+    for (size_t r = 0; r < n_rows; r++) {
+      int pl = rows[r];
+      if (pl < 1 || (size_t)pl > n || (r > 0 && pl < rows[r - 1])) {
+        Rcpp::stop("invalid polyline_index");
+      }
+      starts[pl]++;
+    }
+    for (size_t i = 0; i < n; i++) {
+      starts[i + 1] += starts[i];
+    }
+  }
+
+  std::vector< PolylineSlice > slices(n);
+
+  parallel_for(n, threads, [&](size_t i, int) {
+    PolylineSlice& s = slices[i];
+    s.valid = true;
+    if (lengths != NULL && lengths[i] != (views[i].na ? NA_INTEGER : (int)views[i].len)) {
+      s.valid = false;
+      return;
+    }
+    if (views[i].na) {
+      return;
+    }
+
+    size_t first = from[i] - 1;
+    size_t last = to[i];
+    size_t n_checkpoints = starts[i + 1] - starts[i];
+
+    // checkpoint c (1-based) is before point c * every
+    size_t c0 = std::min(first / every, n_checkpoints);
+    size_t c1 = std::max(c0 + 1, (last + every - 1) / every);
+
+    s.begin = 0;
+    s.base = 0;
+    s.lat = 0;
+    s.lon = 0;
+    if (c0 > 0) {
+      size_t r = starts[i] + c0 - 1;
+      s.begin = rows[r + n_rows];
+      s.base = c0 * every;
+      s.lat = rows[r + 2 * n_rows];
+      s.lon = rows[r + 3 * n_rows];
+    }
+    s.end = c1 <= n_checkpoints ? (size_t)rows[starts[i] + c1 - 1 + n_rows] : views[i].len;
+
+    // a checkpoint is only ever just after the last chunk of a value
+    const char* enc = views[i].encoded;
+    size_t n_points;
+    if (s.begin > s.end || s.end > views[i].len ||
+        (s.begin > 0 && enc[s.begin - 1] - 63 >= 0x20) ||
+        (s.end > 0 && enc[s.end - 1] - 63 >= 0x20) ||
+        !polyline_size(enc + s.begin, s.end - s.begin, &n_points) ||
+        (c1 <= n_checkpoints && n_points != (c1 - c0) * every)) {
+      s.valid = false;
+      return;
+    }
+
+    s.from = std::max(first, s.base);
+    s.to = std::max(s.from, std::min(last, s.base + n_points));
+  });
+
+  std::vector< std::string > col_headers = get_col_headers("XY");
+  Rcpp::List results(n);
+  std::vector< double* > lats(n);
+  std::vector< double* > lons(n);
+
+  for (size_t i = 0; i < n; i++) {
+    if (!slices[i].valid) {
+      Rcpp::stop("the polyline_index doesn't match polyline %i", (int)(i + 1));
+    }
+    if (views[i].na) {
+      results[i] = na_dataframe(col_headers, false);
+      continue;
+    }
+    Rcpp::NumericVector pointsLat = Rcpp::no_init(slices[i].to - slices[i].from);
+    Rcpp::NumericVector pointsLon = Rcpp::no_init(slices[i].to - slices[i].from);
+    lats[i] = pointsLat.begin();
+    lons[i] = pointsLon.begin();
+    results[i] = polyline_dataframe<REALSXP>(pointsLat, pointsLon, col_headers);
+  }
+
+  typedef typename PolylinePrecision<P>::coord_type coord_type;
+
+  parallel_for(n, threads, [&](size_t i, int) {
+    const PolylineSlice& s = slices[i];
+    if (views[i].na || s.from == s.to) {
+      return;
+    }
+    double* lat = lats[i];
+    double* lon = lons[i];
+    decode_polyline_scaled<P>(views[i].encoded + s.begin, s.end - s.begin, s.lat, s.lon,
+                              [&](size_t j, coord_type ilat, coord_type ilon) {
+      size_t p = s.base + j;
+      if (p >= s.from && p < s.to) {
+        lat[p - s.from] = ilat / PolylinePrecision<P>::scale();
+        lon[p - s.from] = ilon / PolylinePrecision<P>::scale();
+      }
+    });
+  });
+
+  return results;
+}
+
+// [[Rcpp::export]]
+Rcpp::List rcpp_polyline_slice(Rcpp::StringVector polylines, SEXP index, int every,
+                               Rcpp::IntegerVector from, Rcpp::IntegerVector to,
+                               int precision, int threads) {
+
+  size_t n = polylines.size();
+  if ((size_t)from.size() != n || (size_t)to.size() != n) {
+    Rcpp::stop("from and to must be the same length as the polylines");
+  }
+
+  const int* f = INTEGER(from);
+  const int* t = INTEGER(to);
+  std::vector< PolylineView > views(n);
+  for (size_t i = 0; i < n; i++) {
+    views[i] = polyline_view(STRING_ELT(polylines, i));
+    if (f[i] == NA_INTEGER || t[i] == NA_INTEGER || f[i] < 1 || t[i] < 0) {
+      Rcpp::stop("invalid from or to");
+    }
+  }
+
+  switch (precision) {
+  case 6:
+    return polyline_slice<6>(views, index, every, f, t, threads);
+  case 7:
+    return polyline_slice<7>(views, index, every, f, t, threads);
+  default:
+    return polyline_slice<5>(views, index, every, f, t, threads);
+  }
+}
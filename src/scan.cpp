@@ -0,0 +1,156 @@
+#include <Rcpp.h>
+
+#include <climits>
+
+#include "googlePolylines.h"
+#include "decoder.h"
+#include "threads.h"
+
+using namespace Rcpp;
+
+// Scans that answer questions about polylines without decoding them into
+// data.frames: nothing is allocated per point.
+
+// Gathers the polylines of each element of a character vector (one each)
+// or of an encoded_column (those of its geometry, less the split markers
+// between polygons), element i being views [offsets[i], offsets[i + 1])
+void scan_views(SEXP polylines, std::vector< PolylineView >& views, std::vector< size_t >& offsets) {
+
+  R_xlen_t n = Rf_xlength(polylines);
+  offsets.assign(n + 1, 0);
+
+  if (TYPEOF(polylines) == STRSXP) {
+    for (R_xlen_t i = 0; i < n; i++) {
+      views.push_back(polyline_view(STRING_ELT(polylines, i)));
+      offsets[i + 1] = views.size();
+    }
+    return;
+  }
+
+  if (TYPEOF(polylines) != VECSXP) {
+    Rcpp::stop("expecting a character vector or a list of them");
+  }
+
+  for (R_xlen_t i = 0; i < n; i++) {
+    SEXP pl = VECTOR_ELT(polylines, i);
+    if (TYPEOF(pl) != STRSXP) {
+      Rcpp::stop("expecting a character vector or a list of them");
+    }
+    R_xlen_t pn = Rf_xlength(pl);
+    for (R_xlen_t j = 0; j < pn; j++) {
+      PolylineView view = polyline_view(STRING_ELT(pl, j));
+      if (!view.na && is_split(view)) {
+        continue;
+      }
+      views.push_back(view);
+    }
+    offsets[i + 1] = views.size();
+  }
+}
+
+// The number of points of each element, counted from the varint
+// terminators alone. An NA polyline makes its element NA.
+// [[Rcpp::export]]
+Rcpp::IntegerVector rcpp_polyline_npoints(SEXP polylines, int threads) {
+
+  std::vector< PolylineView > views;
+  std::vector< size_t > offsets;
+  scan_views(polylines, views, offsets);
+
+  size_t n = offsets.size() - 1;
+  std::vector< size_t > counts(n, 0);
+  std::vector< char > na(n, 0);
+  std::vector< char > valid(n, 1);
+
+  parallel_for(n, threads, [&](size_t i, int) {
+    for (size_t k = offsets[i]; k < offsets[i + 1]; k++) {
+      size_t n_points;
+      if (views[k].na) {
+        na[i] = 1;
+      } else if (polyline_size(views[k].encoded, views[k].len, &n_points)) {
+        counts[i] += n_points;
+      } else {
+        valid[i] = 0;
+        return;
+      }
+    }
+  });
+
+  Rcpp::IntegerVector res(n);
+  for (size_t i = 0; i < n; i++) {
+    if (!valid[i]) {
+      Rcpp::stop("invalid encoded polyline");
+    }
+    if (counts[i] > INT_MAX) {
+      Rcpp::stop("too many points to count in element %i", (int)(i + 1));
+    }
+    res[i] = na[i] ? NA_INTEGER : (int)counts[i];
+  }
+  return res;
+}
+
+template <int P>
+Rcpp::NumericMatrix polyline_bbox(std::vector< PolylineView >& views, std::vector< size_t >& offsets,
+                                  int threads) {
+
+  size_t n = offsets.size() - 1;
+  std::vector< PolylineBBox<P> > boxes(n);
+  std::vector< char > na(n, 0);
+  std::vector< char > valid(n, 1);
+
+  parallel_for(n, threads, [&](size_t i, int) {
+    for (size_t k = offsets[i]; k < offsets[i + 1]; k++) {
+      size_t n_points;
+      if (views[k].na) {
+        na[i] = 1;
+      } else if (polyline_size(views[k].encoded, views[k].len, &n_points)) {
+        boxes[i].add(views[k].encoded, views[k].len);
+      } else {
+        valid[i] = 0;
+        return;
+      }
+    }
+  });
+
+  Rcpp::NumericMatrix res(n, 4);
+  double scale = PolylinePrecision<P>::scale();
+
+  for (size_t i = 0; i < n; i++) {
+    if (!valid[i]) {
+      Rcpp::stop("invalid encoded polyline");
+    }
+    const PolylineBBox<P>& box = boxes[i];
+    if (na[i] || box.n_points == 0) {
+      for (int j = 0; j < 4; j++) {
+        res(i, j) = NA_REAL;
+      }
+      continue;
+    }
+    res(i, 0) = box.min_lon / scale;
+    res(i, 1) = box.min_lat / scale;
+    res(i, 2) = box.max_lon / scale;
+    res(i, 3) = box.max_lat / scale;
+  }
+
+  Rcpp::colnames(res) = Rcpp::CharacterVector::create("xmin", "ymin", "xmax", "ymax");
+  return res;
+}
+
+// The bounding box of each element, one row of xmin, ymin, xmax, ymax each.
+// Elements with no points, or an NA polyline, are NA.
+// [[Rcpp::export]]
+Rcpp::NumericMatrix rcpp_polyline_bbox(SEXP polylines, int precision, int threads) {
+
+  std::vector< PolylineView > views;
+  std::vector< size_t > offsets;
+  scan_views(polylines, views, offsets);
+
+  switch (precision) {
+  case 6:
+    return polyline_bbox<6>(views, offsets, threads);
+  case 7:
+    return polyline_bbox<7>(views, offsets, threads);
+  default:
+    return polyline_bbox<5>(views, offsets, threads);
+  }
+}
@@ -0,0 +1,116 @@
+#include <Rcpp.h>
+
+#include "googlePolylines.h"
+#include "wkb_reader.h"
+#include "wkb_writer.h"
+
+using namespace Rcpp;
+
+template <int P>
+Rcpp::List wkb_to_polyline(Rcpp::List wkb) {
+
+  size_t n = wkb.length();
+  std::string geomType;
+  EncodedPolylines polylines;
+  Rcpp::CharacterVector sv;
+  WkbPolylineReader<P> reader;
+
+  Rcpp::List resultPolylines(n);
+
+  for (size_t i = 0; i < n; i++ ) {
+
+    SEXP raw = VECTOR_ELT(wkb, i);
+
+    // a missing geometry, e.g. an NA blob
+    if (Rf_isNull(raw)) {
+      geomType = "NA";
+      polylines.clear();
+    } else if (TYPEOF(raw) != RAWSXP) {
+      Rcpp::stop("WKB geometries must be raw vectors");
+    } else if (!reader.read(RAW(raw), Rf_xlength(raw), polylines, geomType)) {
+      Rcpp::stop("invalid WKB in element %i", (int)(i + 1));
+    }
+
+    sv = polyline_strings(polylines);
+    sv.attr("sfc") = Rcpp::CharacterVector::create("XY", geomType, "sfg");
+    resultPolylines[i] = sv;
+  }
+
+  return resultPolylines;
+}
+
+// [[Rcpp::export]]
+Rcpp::List rcpp_wkb_to_polyline(Rcpp::List wkb, int precision) {
+  switch (precision) {
+  case 6:
+    return wkb_to_polyline<6>(wkb);
+  case 7:
+    return wkb_to_polyline<7>(wkb);
+  default:
+    return wkb_to_polyline<5>(wkb);
+  }
+}
+
+template <int P>
+Rcpp::List polyline_to_wkb(Rcpp::List sfencoded, bool big_endian) {
+
+  size_t n = sfencoded.size();
+  Rcpp::List res(n);
+  std::vector< WkbPolyline > pls;
+
+  for (size_t i = 0; i < n; i++) {
+
+    Rcpp::StringVector pl = sfencoded[i];
+    if (Rf_isNull(pl.attr("sfc"))) {
+      Rcpp::stop("No geometry attribute found");
+    }
+    Rcpp::CharacterVector cls = pl.attr("sfc");
+
+    // the sf types share their codes with WKB
+    int tp;
+    make_type(cls[1], &tp);
+    if (tp < SF_Point || tp > SF_MultiPolygon) {
+      Rcpp::stop("Unknown geometry type");
+    }
+
+    size_t pn = pl.size();
+    pls.resize(pn);
+    for (size_t j = 0; j < pn; j++) {
+      PolylineView view = polyline_view(STRING_ELT(pl, j));
+      pls[j].encoded = view.encoded;
+      pls[j].len = view.len;
+      pls[j].n = 0;
+      pls[j].split = is_split(view);
+      if (!pls[j].split && (view.na || !polyline_size(view.encoded, view.len, &pls[j].n))) {
+        Rcpp::stop("invalid encoded polyline");
+      }
+    }
+
+    WkbWriter<P> sizer(NULL, big_endian, NA_REAL);
+    sizer.geometry(tp, pls);
+    if (sizer.overflow) {
+      Rcpp::stop("element %i has more points or parts than WKB can hold", (int)(i + 1));
+    }
+
+    Rcpp::RawVector wkb = Rcpp::no_init(sizer.pos);
+    WkbWriter<P> writer(RAW(wkb), big_endian, NA_REAL);
+    writer.geometry(tp, pls);
+
+    res[i] = wkb;
+  }
+
+  res.attr("class") = "WKB";
+  return res;
+}
+
+// [[Rcpp::export]]
+Rcpp::List rcpp_polyline_to_wkb(Rcpp::List sfencoded, bool big_endian, int precision) {
+  switch (precision) {
+  case 6:
+    return polyline_to_wkb<6>(sfencoded, big_endian);
+  case 7:
+    return polyline_to_wkb<7>(sfencoded, big_endian);
+  default:
+    return polyline_to_wkb<5>(sfencoded, big_endian);
+  }
+}
@@ -1,18 +1,15 @@
 
 #include <Rcpp.h>
-#include <b/algorithm/string.hpp>
-#include <b/geometry.hpp>
 
 #include "wkt.h"
 #include "googlePolylines.h"
-#include "variants.h"
+#include "decoder.h"
+#include "wkt_reader.h"
+#include "wkt_writer.h"
+#include "threads.h"
 
 using namespace Rcpp;
 
-void addLonLatToWKTStream(std::ostringstream& os, float lon, float lat ) {
-  os << std::to_string(lon) << " " << std::to_string(lat);
-}
-
 void geom_type(const char *cls, int *tp = NULL) {
   
   int type = 0;
@@ -34,377 +31,390 @@ void geom_type(const char *cls, int *tp = NULL) {
     *tp = type;
 }
 
-void beginWKT(std::ostringstream& os, Rcpp::CharacterVector cls) {
-  
-  int tp;
-  geom_type(cls[1], &tp);
-  //geom_type(cls[0], &tp);  // iff removing XY and sfg attributs
+void beginWKT(WktWriter& os, int tp) {
   
   switch( tp ) {
   case POINT:
-    os << "POINT ";
+    os.write("POINT ");
     break;
   case MULTIPOINT:
-    os << "MULTIPOINT (";
+    os.write("MULTIPOINT (");
     break;
   case LINESTRING:
-    os << "LINESTRING ";
+    os.write("LINESTRING ");
     break;
   case MULTILINESTRING:
-    os << "MULTILINESTRING (";
+    os.write("MULTILINESTRING (");
     break;
   case POLYGON:
-    os << "POLYGON (";
+    os.write("POLYGON (");
     break;
   case MULTIPOLYGON:
-    os << "MULTIPOLYGON ((";
+    os.write("MULTIPOLYGON ((");
     break;
-  default: {
-      Rcpp::stop("Unknown geometry type");
-    }
   }
 }
 
-void endWKT(std::ostringstream& os, Rcpp::CharacterVector cls) {
-  
-  int tp;
-  geom_type(cls[1], &tp);
-  //geom_type(cls[0], &tp);
+void endWKT(WktWriter& os, int tp) {
   
   switch( tp ) {
   case POINT:
-    os << "";
+    os.write("");
     break;
   case MULTIPOINT:
-    os << ")";
+    os.write(")");
     break;
   case LINESTRING:
-    os << "";
+    os.write("");
     break;
   case MULTILINESTRING:
-    os << ")";
+    os.write(")");
     break;
   case POLYGON:
-    os << ")";
+    os.write(")");
     break;
   case MULTIPOLYGON:
-    os << "))";
+    os.write("))");
     break;
-  default: {
-      Rcpp::stop("Unknown geometry type");
-    }
   }
 }
 
-void coordSeparateWKT(std::ostringstream& os) {
-  os << ", ";
+// The WKT geometry type of an element of an encoded_column
+int wkt_type(SEXP pl) {
+  
+  SEXP cls = Rf_getAttrib(pl, Rf_install("sfc"));
+  
+  if(Rf_isNull(cls)){
+    Rcpp::stop("No geometry attribute found");
+  }
+  
+  int tp;
+  geom_type(CHAR(STRING_ELT(cls, 1)), &tp);
+  //geom_type(cls[0], &tp);  // iff removing XY and sfg attributs
+  
+  if (tp == UNKNOWN) {
+    Rcpp::stop("Unknown geometry type");
+  }
+  return tp;
+}
+
+// True if any of the n polylines of a geometry is NA. There is no WKT for
+// it, so the geometry is NA, as an NA feature of an encoded_columnar is.
+bool has_na(const PolylineView* views, size_t n) {
+  for (size_t j = 0; j < n; j++) {
+    if (views[j].na) {
+      return true;
+    }
+  }
+  return false;
 }
 
-// [[Rcpp::export]]
-Rcpp::StringVector rcpp_polyline_to_wkt(Rcpp::List sfencoded) {
+// Writes the n polylines of one geometry as WKT. Returns false if any of them
+// is not a valid polyline.
+bool geometryToWKT(WktWriter& os, int tp, const PolylineView* views, size_t n) {
   
-  unsigned int nrow = sfencoded.size();
-  Rcpp::StringVector res(nrow);
-  std::string stdspl;
-  Rcpp::CharacterVector cls;
-  Rcpp::StringVector pl;
-  Rcpp::String spl;
-
-  for (size_t i = 0; i < nrow; i++ ){
+  beginWKT(os, tp);
+  
+  for(size_t j = 0; j < n; j ++ ) {
     
-    std::ostringstream os;
-    stdspl.clear();
-
-    pl = sfencoded[i];
-
-    if(!Rf_isNull(pl.attr("sfc"))){
-      cls = pl.attr("sfc"); 
+    if(is_split(views[j])){
+      os.write("),(");
     }else{
-      Rcpp::stop("No geometry attribute found");
+      os.write("(");
+      if (!polylineToWKT(os, views[j].encoded, views[j].len)) {
+        return false;
+      }
+      os.write(")");
+      if(n > 1 && j < (n - 1)){
+        if(!is_split(views[j + 1])){
+          os.write(",");
+        }
+      }
     }
+  }
+  endWKT(os, tp);
+  return true;
+}
 
-    beginWKT(os, cls);
-    unsigned int n =  pl.size();
+// Parallel version of rcpp_polyline_to_wkt(). The types and polylines are
+// gathered serially, and each geometry is written on one of `threads`
+// workers, after the text of that worker's earlier geometries. The strings
+// are made in order afterwards from where each was written.
+Rcpp::StringVector polyline_to_wkt_parallel(Rcpp::List sfencoded, int precision, int digits, int threads) {
   
-    for(size_t j = 0; j < n; j ++ ) {
+  size_t nrow = sfencoded.size();
+  std::vector< int > types(nrow);
+  std::vector< PolylineView > views;
+  std::vector< size_t > offsets(nrow + 1, 0);
   
-      spl = pl[j];
-      
-      if(spl == SPLIT_CHAR){
-        os << "),(";
-      }else{
-        stdspl = spl;
-        os << "(";
-        polylineToWKT(os, stdspl);
-        os << ")";
-        if(n > 1 && j < (n - 1)){
-          if(pl[j+1] != SPLIT_CHAR){
-            os << ",";
-          }
-        }
-      }
-      
+  for (size_t i = 0; i < nrow; i++) {
+    SEXP pl = VECTOR_ELT(sfencoded, i);
+    types[i] = wkt_type(pl);
+    
+    R_xlen_t n = Rf_xlength(pl);
+    for (R_xlen_t j = 0; j < n; j++) {
+      views.push_back(polyline_view(STRING_ELT(pl, j)));
+    }
+    offsets[i + 1] = views.size();
+    if (has_na(views.data() + offsets[i], n)) {
+      types[i] = UNKNOWN;
     }
-    endWKT(os, cls);
-    res[i] = os.str();
   }
   
-  return res;
+  std::vector< EncodedRange > wkt(nrow);
+  std::vector< char > valid(nrow, 1);
+  std::vector< WktWriter > writers(threads, WktWriter(precision, digits));
+  
+  parallel_for(nrow, threads, [&](size_t i, int worker) {
+    if (types[i] == UNKNOWN) {
+      return;
+    }
+    WktWriter& os = writers[worker];
+    wkt[i].worker = worker;
+    wkt[i].first = os.size;
+    valid[i] = geometryToWKT(os, types[i], views.data() + offsets[i], offsets[i + 1] - offsets[i]);
+    wkt[i].last = os.size;
+  });
   
+  Rcpp::StringVector res(nrow);
+  for (size_t i = 0; i < nrow; i++) {
+    if (!valid[i]) {
+      Rcpp::stop("invalid encoded polyline");
+    }
+    if (types[i] == UNKNOWN) {
+      SET_STRING_ELT(res, i, NA_STRING);
+      continue;
+    }
+    const EncodedRange& r = wkt[i];
+    SET_STRING_ELT(res, i, Rf_mkCharLen(writers[r.worker].buffer.data() + r.first, r.last - r.first));
+  }
+  return res;
 }
 
+// [[Rcpp::export]]
+Rcpp::StringVector rcpp_polyline_to_wkt(Rcpp::List sfencoded, int precision, int digits, int threads) {
+  
+  if (threads > 1) {
+    return polyline_to_wkt_parallel(sfencoded, precision, digits, threads);
+  }
+  
+  unsigned int nrow = sfencoded.size();
+  Rcpp::StringVector res(nrow);
+  std::vector< PolylineView > views;
+  WktWriter os(precision, digits);
 
-void polylineToWKT(std::ostringstream& os, std::string encoded){
-  
-  int len = encoded.size();
-  int index = 0;
-  float lat = 0;
-  float lng = 0;
-  
-  while (index < len){
-    char b;
-    unsigned int shift = 0;
-    int result = 0;
-    do {
-      b = encoded.at(index++) - 63;
-      result |= (b & 0x1f) << shift;
-      shift += 5;
-    } while (b >= 0x20);
-    float dlat = ((result & 1) ? ~(result >> 1) : (result >> 1));
-    lat += dlat;
+  for (size_t i = 0; i < nrow; i++ ){
     
-    shift = 0;
-    result = 0;
-    do {
-      b = encoded.at(index++) - 63;
-      result |= (b & 0x1f) << shift;
-      shift += 5;
-    } while (b >= 0x20);
-    float dlng = ((result & 1) ? ~(result >> 1) : (result >> 1));
-    lng += dlng;
+    os.clear();
 
-    addLonLatToWKTStream(os, lng* (float)1e-5, lat* (float)1e-5);
+    SEXP pl = sfencoded[i];
+    int tp = wkt_type(pl);
+    
+    unsigned int n = Rf_xlength(pl);
+    views.resize(n);
+    for(size_t j = 0; j < n; j ++ ) {
+      views[j] = polyline_view(STRING_ELT(pl, j));
+    }
+    
+    if (has_na(views.data(), n)) {
+      SET_STRING_ELT(res, i, NA_STRING);
+      continue;
+    }
     
-    if(index < len) {
-      coordSeparateWKT(os);
+    if (!geometryToWKT(os, tp, views.data(), n)) {
+      Rcpp::stop("invalid encoded polyline");
     }
+    SET_STRING_ELT(res, i, Rf_mkCharLen(os.buffer.data(), os.size));
   }
+  
+  return res;
+  
 }
 
-
-/*
-void ReplaceStringInPlace(std::string& subject, const std::string& search,
-                          const std::string& replace) {
-  size_t pos = 0;
-  while ((pos = subject.find(search, pos)) != std::string::npos) {
-    subject.replace(pos, search.length(), replace);
-    pos += replace.length();
+// The WKT geometry type of an sf type code
+int wkt_type(int sf_type) {
+  switch (sf_type) {
+  case SF_Point:
+    return POINT;
+  case SF_MultiPoint:
+    return MULTIPOINT;
+  case SF_LineString:
+    return LINESTRING;
+  case SF_MultiLineString:
+    return MULTILINESTRING;
+  case SF_Polygon:
+    return POLYGON;
+  case SF_MultiPolygon:
+    return MULTIPOLYGON;
   }
-}
-*/
-
-/**
- * Finds the 'GEOMETRY' text
- */
-std::string geomFromWKT(std::string& pl) {
-  size_t s = pl.find_first_of("(");
-  std::string geom = pl.substr(0, s);
-  boost::trim(geom);
-//  pl.replace(0, s, "");
-  
-  return geom;
+  Rcpp::stop("Unknown geometry type");
+  return UNKNOWN;
 }
 
-template <typename Point>
-void encode_wkt_point(Point const& p, std::ostringstream& os) {
+// Writes the geometries of an encoded_columnar as WKT, reading the polylines
+// in place from its buffer. NA features are NA.
+// [[Rcpp::export]]
+Rcpp::StringVector rcpp_columnar_to_wkt(Rcpp::IntegerVector features, Rcpp::List columnar,
+                                        int precision, int digits, int threads) {
+  
+  ColumnarPolylines cp = columnar_polylines(columnar);
+  size_t nrow = features.size();
+  std::vector< int > types(nrow);
+  std::vector< PolylineView > views;
+  std::vector< size_t > offsets(nrow + 1, 0);
+  
+  for (size_t i = 0; i < nrow; i++) {
+    int tp = columnar_views(cp, features[i], views, true);
+    types[i] = tp == SF_Unknown ? UNKNOWN : wkt_type(tp);
+    offsets[i + 1] = views.size();
+  }
   
-  global_vars::lons.clear();
-  global_vars::lats.clear();
-
-  global_vars::lons.push_back(boost::geometry::get<0>(p));
-  global_vars::lats.push_back(boost::geometry::get<1>(p));
+  std::vector< EncodedRange > wkt(nrow);
+  std::vector< char > valid(nrow, 1);
+  std::vector< WktWriter > writers(std::max(threads, 1), WktWriter(precision, digits));
   
-  global_vars::encodedString = encode_polyline();
+  // each worker writes its geometries one after another into its own writer
+  parallel_for(nrow, threads, [&](size_t i, int worker) {
+    if (types[i] == UNKNOWN) {
+      return;
+    }
+    WktWriter& os = writers[worker];
+    wkt[i].worker = worker;
+    wkt[i].first = os.size;
+    valid[i] = geometryToWKT(os, types[i], views.data() + offsets[i], offsets[i + 1] - offsets[i]);
+    wkt[i].last = os.size;
+  });
   
-  addToStream(os);
+  Rcpp::StringVector res(nrow);
+  for (size_t i = 0; i < nrow; i++) {
+    if (!valid[i]) {
+      Rcpp::stop("invalid encoded polyline");
+    }
+    if (types[i] == UNKNOWN) {
+      SET_STRING_ELT(res, i, NA_STRING);
+      continue;
+    }
+    const EncodedRange& r = wkt[i];
+    SET_STRING_ELT(res, i, Rf_mkCharLen(writers[r.worker].buffer.data() + r.first, r.last - r.first));
+  }
+  return res;
 }
 
-
-template <typename MultiPoint>
-void encode_wkt_multipoint(MultiPoint const& mp, std::ostringstream& os) {
-  
-  typedef typename boost::range_iterator
-  <
-    multi_point_type const
-  >::type iterator_type;
-  
-  for (iterator_type it = boost::begin(mp); 
-       it != boost::end(mp);
-       ++it) 
-  {
-    encode_wkt_point(*it, os);
+template <int P>
+bool polylineToWKT(WktWriter& os, const char* encoded, size_t len){
+  
+  typedef typename PolylinePrecision<P>::coord_type coord_type;
+  size_t n;
+  
+  if (!polyline_size(encoded, len, &n)) {
+    return false;
   }
   
+  os.reserve(n * WKT_MAX_COORD_CHARS);
+  
+  decode_polyline_scaled<P>(encoded, len, [&](size_t i, coord_type lat, coord_type lon) {
+    os.coordinate(i, lon, lat);
+  });
+  return true;
 }
 
-template <typename LineString>
-void encode_wkt_linestring(LineString const& ls, std::ostringstream& os) {
-  
-  // works for RINGS (because it's templated)
-  
-  typedef typename boost::range_iterator
-    <
-      linestring_type const
-    >::type iterator_type;
-  
-  for (iterator_type it = boost::begin(ls);
-       it != boost::end(ls);
-       ++it)
-  {
-    global_vars::lons.push_back(boost::geometry::get<0>(*it));
-    global_vars::lats.push_back(boost::geometry::get<1>(*it));
+bool polylineToWKT(WktWriter& os, const char* encoded, size_t len){
+  switch (os.precision) {
+  case 6:
+    return polylineToWKT<6>(os, encoded, len);
+  case 7:
+    return polylineToWKT<7>(os, encoded, len);
+  default:
+    return polylineToWKT<5>(os, encoded, len);
   }
-  global_vars::encodedString = encode_polyline();
-  addToStream(os);
 }
 
-template <typename MultiLinestring>
-void encode_wkt_multi_linestring(MultiLinestring const& mls, std::ostringstream& os) {
-  
-  typedef typename boost::range_iterator
-  <
-    multi_linestring_type const
-  >::type iterator_type;
-  
-  for (iterator_type it = boost::begin(mls);
-       it != boost::end(mls);
-       ++it)
-  {
-    encode_wkt_linestring(*it, os);
-  }
-}
 
-template <typename Polygon>
-void encode_wkt_polygon(Polygon const& pl, std::ostringstream& os) {
+// Parallel version of rcpp_wkt_to_polyline(). The CHAR() pointers are taken
+// serially, and the text is read and encoded on `threads` workers, each
+// appending to its own buffer and recording the parts each geometry took.
+// The character vectors are made in order afterwards.
+template <int P>
+Rcpp::List wkt_to_polyline_parallel(Rcpp::StringVector wkt, int threads) {
   
-  encode_wkt_linestring(pl.outer(), os);
+  size_t n = wkt.length();
+  std::vector< PolylineView > views(n);
+  for (size_t i = 0; i < n; i++) {
+    views[i] = polyline_view(STRING_ELT(wkt, i));
+  }
   
-  // perhaps use
-  // https://stackoverflow.com/questions/7722087/getting-the-coordinates-of-points-from-a-boost-geometry-polygon/7748091#7748091
-  // https://stackoverflow.com/questions/37071031/how-to-get-a-polygon-from-boostgeometrymodelpolygon
-  for (auto& i: pl.inners() ) {
-    encode_wkt_linestring(i, os);
+  std::vector< EncodedPolylines > polylines(threads);
+  std::vector< EncodedRange > ranges(n);
+  std::vector< std::string > geomTypes(n, "NA");
+  std::vector< char > valid(n, 1);
+  std::vector< WktPolylineReader<P> > readers(threads);
+  
+  parallel_for(n, threads, [&](size_t i, int worker) {
+    EncodedPolylines& out = polylines[worker];
+    ranges[i].worker = worker;
+    ranges[i].first = out.parts();
+    if (!views[i].na) {
+      valid[i] = readers[worker].read(views[i].encoded, views[i].len, out, geomTypes[i]);
+    }
+    ranges[i].last = out.parts();
+  });
+  
+  Rcpp::List resultPolylines(n);
+  Rcpp::CharacterVector sv;
+  for (size_t i = 0; i < n; i++) {
+    if (!valid[i]) {
+      Rcpp::stop("invalid WKT in element %i", (int)(i + 1));
+    }
+    const EncodedRange& r = ranges[i];
+    sv = polyline_strings(polylines[r.worker], r.first, r.last);
+    sv.attr("sfc") = Rcpp::CharacterVector::create("XY", geomTypes[i], "sfg");
+    resultPolylines[i] = sv;
   }
+  return resultPolylines;
 }
 
-template <typename MultiPolygon>
-void encode_wkt_multi_polygon(MultiPolygon const& mpl, std::ostringstream& os) {
-  
-  typedef typename boost::range_iterator
-  <
-    multi_polygon_type const
-  >::type iterator_type;
-  
-  global_vars::encodedString = SPLIT_CHAR;
-  for (iterator_type it = boost::begin(mpl);
-       it != boost::end(mpl);
-       ++it)
-  {
-    encode_wkt_polygon(*it, os);
-    addToStream(os);
+template <int P>
+Rcpp::List wkt_to_polyline(Rcpp::StringVector wkt, int threads) {
+  
+  if (threads > 1) {
+    return wkt_to_polyline_parallel<P>(wkt, threads);
   }
-}
-
-// [[Rcpp::export]]
-Rcpp::List rcpp_wkt_to_polyline(Rcpp::StringVector wkt) {
   
   size_t n = wkt.length();
-  Rcpp::String r_wkt;
-  std::string str_wkt;
   std::string geomType;
-  std::vector<std::string> cls;
+  EncodedPolylines polylines;
   Rcpp::CharacterVector sv;
+  WktPolylineReader<P> reader;
   
   Rcpp::List resultPolylines(n);
-  int lastItem;
-  unsigned int i;
   
-  for (i = 0; i < n; i++ ) {
-    
-    std::ostringstream os;
-    
-    r_wkt = wkt[i];
-    str_wkt = r_wkt;
-    geomType = geomFromWKT(str_wkt);
-    
-    
-    cls.clear();
-    cls.push_back("XY");
-    cls.push_back(geomType);
-    cls.push_back("sfg");
+  for (size_t i = 0; i < n; i++ ) {
     
-    //Rcpp::CharacterVector cls(1);
-    //cls[0] = geomType;
+    PolylineView view = polyline_view(STRING_ELT(wkt, i));
     
-    if (geomType == "POINT" ) {
-      
-      point_type pt;
-      boost::geometry::read_wkt(str_wkt, pt);
-      encode_wkt_point(pt, os);
-      
-    }else if (geomType == "MULTIPOINT" ) {
-      
-      multi_point_type mp;
-      boost::geometry::read_wkt(str_wkt, mp);
-      encode_wkt_multipoint(mp, os);
-      
-    }else if (geomType == "LINESTRING" ) {
-      
-      linestring_type ls;
-      boost::geometry::read_wkt(str_wkt, ls);
-      encode_wkt_linestring(ls, os);
-      
-    }else if (geomType == "MULTILINESTRING" ) {
-      
-      multi_linestring_type mls;
-      boost::geometry::read_wkt(str_wkt, mls);
-      encode_wkt_multi_linestring(mls, os);
-      
-    }else if (geomType == "POLYGON" ) { 
-      
-      polygon_type pl;
-      boost::geometry::read_wkt(str_wkt, pl);
-      encode_wkt_polygon(pl, os);
-      
-    }else if (geomType == "MULTIPOLYGON" ) {
-      
-      multi_polygon_type mpl;
-      boost::geometry::read_wkt(str_wkt, mpl);
-      encode_wkt_multi_polygon(mpl, os);
+    polylines.clear();
+    if (view.na) {
+      geomType = "NA";
+    } else if (!reader.read(view.encoded, view.len, polylines, geomType)) {
+      Rcpp::stop("invalid WKT in element %i", (int)(i + 1));
     }
     
-    std::string str = os.str();
-    split(str, ' ');
-    
-    if(global_vars::elems.size() > 1) {
-      lastItem = global_vars::elems.size() - 1;
-      
-      if (global_vars::elems[lastItem] == "-") {
-        global_vars::elems.erase(global_vars::elems.end() - 1);
-      }
-    }
-    
-    sv = wrap(global_vars::elems);
-    sv.attr("sfc") = cls;
+    sv = polyline_strings(polylines);
+    sv.attr("sfc") = Rcpp::CharacterVector::create("XY", geomType, "sfg");
     resultPolylines[i] = sv;
   }
   
   return resultPolylines;
 }
 
-
-
-
-
-
-
+// [[Rcpp::export]]
+Rcpp::List rcpp_wkt_to_polyline(Rcpp::StringVector wkt, int precision, int threads) {
+  switch (precision) {
+  case 6:
+    return wkt_to_polyline<6>(wkt, threads);
+  case 7:
+    return wkt_to_polyline<7>(wkt, threads);
+  default:
+    return wkt_to_polyline<5>(wkt, threads);
+  }
+}